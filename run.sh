@@ -1,3 +1,3 @@
 #!/bin/bash
 
-g++ src/*.cpp -lraylib -o app && ./app
+g++ src/*.cpp -pthread -lraylib -o app && ./app
@@ -1,150 +1,202 @@
 #pragma once
 
 #include "bitboard.h"
-#include <cstdlib>
-#include <cstring>
+#include <cstdint>
 
 // ============================================================================
 // Attack Tables
 // ============================================================================
-// Precomputed attack bitboards for non-sliding pieces.
-// Sliding pieces (bishop, rook, queen) use on-the-fly generation.
+// Every table is built by constexpr functions at compile time, so there is
+// nothing to initialize at runtime and the tables are safe to read from any
+// thread. Sliding pieces use the ray tables: the first blocker on each ray
+// is found with a bit scan and its own ray is cut off.
 
 namespace Attacks {
 
-// Attack tables: [color][square] for pawns, [square] for others
-inline uint64_t pawnAttacks[2][64];
-inline uint64_t knightAttacks[64];
-inline uint64_t kingAttacks[64];
-inline bool initialized = false;
+// Ray directions: on the first four (toward h8) the nearest blocker is the
+// lowest set bit, on the last four the highest
+enum Direction { NORTH, EAST, NORTH_EAST, NORTH_WEST, SOUTH, WEST, SOUTH_WEST, SOUTH_EAST };
+
+constexpr int DIRECTION_RANK[8] = { 1, 0, 1, 1, -1, 0, -1, -1 };
+constexpr int DIRECTION_FILE[8] = { 0, 1, 1, -1, 0, -1, -1, 1 };
 
 // ============================================================================
-// Initialization
+// Table Generation
 // ============================================================================
 
-inline void Init() {
-    if ( initialized )
-        return;
-
-    memset( pawnAttacks, 0, sizeof( pawnAttacks ) );
-    memset( knightAttacks, 0, sizeof( knightAttacks ) );
-    memset( kingAttacks, 0, sizeof( kingAttacks ) );
-
-    for ( int sq = 0; sq < 64; ++sq ) {
-        int rank = RankOf( sq );
-        int file = FileOf( sq );
-
-        // -----------------------------------------------------------------
-        // Pawn attacks
-        // -----------------------------------------------------------------
-        // White pawns attack diagonally upward (+7, +9)
-        //     . X .
-        //     . P .
-        if ( rank < 7 ) {
-            if ( file > 0 )
-                pawnAttacks[WHITE_SIDE][sq] |= 1ULL << ( sq + 7 );
-            if ( file < 7 )
-                pawnAttacks[WHITE_SIDE][sq] |= 1ULL << ( sq + 9 );
-        }
-        // Black pawns attack diagonally downward (-7, -9)
-        //     . p .
-        //     . X .
-        if ( rank > 0 ) {
-            if ( file > 0 )
-                pawnAttacks[BLACK_SIDE][sq] |= 1ULL << ( sq - 9 );
-            if ( file < 7 )
-                pawnAttacks[BLACK_SIDE][sq] |= 1ULL << ( sq - 7 );
-        }
+inline constexpr bool OnBoard( int rank, int file ) { return rank >= 0 && rank < 8 && file >= 0 && file < 8; }
 
-        // -----------------------------------------------------------------
-        // Knight attacks
-        // -----------------------------------------------------------------
-        // Knights move in an "L" shape: 2+1 or 1+2 squares
-        //     . X . X .
-        //     X . . . X
-        //     . . N . .
-        //     X . . . X
-        //     . X . X .
-        const int knightDirs[] = { -17, -15, -10, -6, 6, 10, 15, 17 };
-        for ( int dir : knightDirs ) {
-            int target = sq + dir;
-            if ( target >= 0 && target < 64 ) {
-                int targetFile = FileOf( target );
-                if ( abs( file - targetFile ) <= 2 ) {
-                    knightAttacks[sq] |= 1ULL << target;
-                }
-            }
+// Squares reached by single steps of (rank, file) offsets
+inline constexpr uint64_t Steps( int square, const int ( &offsets )[8][2], int count ) {
+    uint64_t result = 0;
+    for ( int i = 0; i < count; i++ ) {
+        int rank = RankOf( square ) + offsets[i][0];
+        int file = FileOf( square ) + offsets[i][1];
+        if ( OnBoard( rank, file ) )
+            result |= 1ULL << MakeSquare( rank, file );
+    }
+    return result;
+}
+
+// Empty-board ray from a square, excluding the square itself
+inline constexpr uint64_t Ray( int square, int direction ) {
+    uint64_t result = 0;
+    int rank = RankOf( square ) + DIRECTION_RANK[direction];
+    int file = FileOf( square ) + DIRECTION_FILE[direction];
+    for ( ; OnBoard( rank, file ); rank += DIRECTION_RANK[direction], file += DIRECTION_FILE[direction] ) {
+        result |= 1ULL << MakeSquare( rank, file );
+    }
+    return result;
+}
+
+struct Tables {
+    uint64_t pawn[2][64]; // [color][square]
+    uint64_t knight[64];
+    uint64_t king[64];
+    uint64_t rays[8][64];           // [direction][square]
+    uint64_t between[64][64];       // Squares strictly between two aligned squares, else 0
+    uint64_t line[64][64];          // Whole line through two aligned squares, else 0
+    uint64_t fileMask[8];           // [file]
+    uint64_t adjacentFiles[8];      // [file] neighbouring files, not the file itself
+    uint64_t passedPawnMask[2][64]; // [color][square] enemy pawns here stop a passer
+};
+
+inline constexpr Tables BuildTables() {
+    constexpr int knightOffsets[8][2] = { { 2, 1 }, { 2, -1 }, { -2, 1 }, { -2, -1 },
+                                          { 1, 2 }, { 1, -2 }, { -1, 2 }, { -1, -2 } };
+    constexpr int kingOffsets[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+                                        { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+    constexpr int whitePawnOffsets[8][2] = { { 1, -1 }, { 1, 1 } };
+    constexpr int blackPawnOffsets[8][2] = { { -1, -1 }, { -1, 1 } };
+
+    Tables t{};
+    for ( int file = 0; file < 8; file++ ) {
+        t.fileMask[file] = FILE_A << file;
+    }
+    for ( int file = 0; file < 8; file++ ) {
+        t.adjacentFiles[file] = ( file > 0 ? t.fileMask[file - 1] : 0 ) | ( file < 7 ? t.fileMask[file + 1] : 0 );
+    }
+
+    for ( int sq = 0; sq < 64; sq++ ) {
+        t.pawn[WHITE_SIDE][sq] = Steps( sq, whitePawnOffsets, 2 );
+        t.pawn[BLACK_SIDE][sq] = Steps( sq, blackPawnOffsets, 2 );
+        t.knight[sq] = Steps( sq, knightOffsets, 8 );
+        t.king[sq] = Steps( sq, kingOffsets, 8 );
+        for ( int direction = 0; direction < 8; direction++ ) {
+            t.rays[direction][sq] = Ray( sq, direction );
         }
 
-        // -----------------------------------------------------------------
-        // King attacks
-        // -----------------------------------------------------------------
-        // King moves one square in any direction
-        //     X X X
-        //     X K X
-        //     X X X
-        const int kingDirs[] = { -9, -8, -7, -1, 1, 7, 8, 9 };
-        for ( int dir : kingDirs ) {
-            int target = sq + dir;
-            if ( target >= 0 && target < 64 ) {
-                int targetFile = FileOf( target );
-                if ( abs( file - targetFile ) <= 1 ) {
-                    kingAttacks[sq] |= 1ULL << target;
-                }
+        uint64_t span = t.fileMask[FileOf( sq )] | t.adjacentFiles[FileOf( sq )];
+        t.passedPawnMask[WHITE_SIDE][sq] = span & ~( ( 2ULL << ( sq | 7 ) ) - 1 ); // Ranks above
+        t.passedPawnMask[BLACK_SIDE][sq] = span & ( ( 1ULL << ( sq & 56 ) ) - 1 ); // Ranks below
+    }
+
+    // Walk outward from each square, so everything walked so far is between
+    for ( int from = 0; from < 64; from++ ) {
+        for ( int direction = 0; direction < 8; direction++ ) {
+            uint64_t fullLine = t.rays[direction][from] | t.rays[( direction + 4 ) % 8][from] | ( 1ULL << from );
+            uint64_t walked = 0;
+            int rank = RankOf( from ) + DIRECTION_RANK[direction];
+            int file = FileOf( from ) + DIRECTION_FILE[direction];
+            for ( ; OnBoard( rank, file ); rank += DIRECTION_RANK[direction], file += DIRECTION_FILE[direction] ) {
+                int to = MakeSquare( rank, file );
+                t.between[from][to] = walked;
+                t.line[from][to] = fullLine;
+                walked |= 1ULL << to;
             }
         }
     }
-
-    initialized = true;
+    return t;
 }
 
+inline constexpr Tables TABLES = BuildTables();
+
+// Named views, so call sites read Attacks::knightAttacks[square]
+inline constexpr const uint64_t ( &pawnAttacks )[2][64] = TABLES.pawn;
+inline constexpr const uint64_t ( &knightAttacks )[64] = TABLES.knight;
+inline constexpr const uint64_t ( &kingAttacks )[64] = TABLES.king;
+inline constexpr const uint64_t ( &rays )[8][64] = TABLES.rays;
+inline constexpr const uint64_t ( &between )[64][64] = TABLES.between;
+inline constexpr const uint64_t ( &line )[64][64] = TABLES.line;
+inline constexpr const uint64_t ( &fileMask )[8] = TABLES.fileMask;
+inline constexpr const uint64_t ( &adjacentFiles )[8] = TABLES.adjacentFiles;
+inline constexpr const uint64_t ( &passedPawnMask )[2][64] = TABLES.passedPawnMask;
+
 // ============================================================================
-// Sliding Piece Attacks (computed on-the-fly with blockers)
+// Sliding Piece Attacks
 // ============================================================================
 
-// Get bishop attacks from a square with given blocker configuration
-inline uint64_t GetBishopAttacks( int square, uint64_t blockers ) {
-    uint64_t attacks = 0ULL;
-    int r = RankOf( square );
-    int f = FileOf( square );
-
-    // Four diagonal directions: NE, NW, SE, SW
-    int dirs[][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
-
-    for ( auto &d : dirs ) {
-        for ( int tr = r + d[0], tf = f + d[1]; tr >= 0 && tr <= 7 && tf >= 0 && tf <= 7; tr += d[0], tf += d[1] ) {
-            int sq = MakeSquare( tr, tf );
-            attacks |= 1ULL << sq;
-            if ( blockers & ( 1ULL << sq ) )
-                break;
-        }
+// Ray attacks up to and including the first blocker
+inline constexpr uint64_t RayAttacks( int square, int direction, uint64_t blockers ) {
+    uint64_t attacks = rays[direction][square];
+    uint64_t blocked = attacks & blockers;
+    if ( blocked ) {
+        int first = direction < SOUTH ? __builtin_ctzll( blocked ) : 63 - __builtin_clzll( blocked );
+        attacks ^= rays[direction][first];
     }
     return attacks;
 }
 
+// Get bishop attacks from a square with given blocker configuration
+inline constexpr uint64_t GetBishopAttacks( int square, uint64_t blockers ) {
+    return RayAttacks( square, NORTH_EAST, blockers ) | RayAttacks( square, NORTH_WEST, blockers ) |
+           RayAttacks( square, SOUTH_WEST, blockers ) | RayAttacks( square, SOUTH_EAST, blockers );
+}
+
 // Get rook attacks from a square with given blocker configuration
-inline uint64_t GetRookAttacks( int square, uint64_t blockers ) {
-    uint64_t attacks = 0ULL;
-    int r = RankOf( square );
-    int f = FileOf( square );
-
-    // Four straight directions: N, S, E, W
-    int dirs[][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
-
-    for ( auto &d : dirs ) {
-        for ( int tr = r + d[0], tf = f + d[1]; tr >= 0 && tr <= 7 && tf >= 0 && tf <= 7; tr += d[0], tf += d[1] ) {
-            int sq = MakeSquare( tr, tf );
-            attacks |= 1ULL << sq;
-            if ( blockers & ( 1ULL << sq ) )
-                break;
-        }
-    }
-    return attacks;
+inline constexpr uint64_t GetRookAttacks( int square, uint64_t blockers ) {
+    return RayAttacks( square, NORTH, blockers ) | RayAttacks( square, EAST, blockers ) |
+           RayAttacks( square, SOUTH, blockers ) | RayAttacks( square, WEST, blockers );
 }
 
 // Get queen attacks (union of bishop and rook attacks)
-inline uint64_t GetQueenAttacks( int square, uint64_t blockers ) {
+inline constexpr uint64_t GetQueenAttacks( int square, uint64_t blockers ) {
     return GetBishopAttacks( square, blockers ) | GetRookAttacks( square, blockers );
 }
 
+// ============================================================================
+// Compile-time Checks
+// ============================================================================
+
+inline constexpr int TotalBits( const uint64_t ( &table )[64] ) {
+    int total = 0;
+    for ( uint64_t entry : table ) {
+        total += __builtin_popcountll( entry );
+    }
+    return total;
+}
+
+// Leapers: known totals and corner/center cases
+static_assert( TotalBits( knightAttacks ) == 336 && TotalBits( kingAttacks ) == 420 );
+static_assert( TotalBits( pawnAttacks[WHITE_SIDE] ) == 98 && TotalBits( pawnAttacks[BLACK_SIDE] ) == 98 );
+static_assert( knightAttacks[A1] == ( ( 1ULL << B3 ) | ( 1ULL << C2 ) ) );
+static_assert( __builtin_popcountll( knightAttacks[E4] ) == 8 && __builtin_popcountll( kingAttacks[E4] ) == 8 );
+static_assert( kingAttacks[H8] == ( ( 1ULL << G8 ) | ( 1ULL << G7 ) | ( 1ULL << H7 ) ) );
+static_assert( pawnAttacks[WHITE_SIDE][A2] == 1ULL << B3 && pawnAttacks[BLACK_SIDE][H7] == 1ULL << G6 );
+static_assert( pawnAttacks[WHITE_SIDE][E8] == 0 && pawnAttacks[BLACK_SIDE][E1] == 0 );
+
+// Rays, between and line
+static_assert( rays[NORTH][A1] == ( FILE_A & ~( 1ULL << A1 ) ) && rays[WEST][A1] == 0 );
+static_assert( rays[NORTH_EAST][A1] == 0x8040201008040200ULL );
+static_assert( between[A1][H8] == 0x0040201008040200ULL && between[H8][A1] == between[A1][H8] );
+static_assert( between[E1][E2] == 0 && between[A1][B3] == 0 && between[E4][E4] == 0 );
+static_assert( between[A1][D1] == ( ( 1ULL << B1 ) | ( 1ULL << C1 ) ) );
+static_assert( line[B2][D4] == 0x8040201008040201ULL && line[A1][B3] == 0 && line[C1][C7] == FILE_C );
+
+// Masks
+static_assert( fileMask[0] == FILE_A && fileMask[7] == FILE_H );
+static_assert( adjacentFiles[0] == FILE_B && adjacentFiles[4] == ( FILE_D | FILE_F ) );
+static_assert( passedPawnMask[WHITE_SIDE][E4] ==
+               ( ( FILE_D | FILE_E | FILE_F ) & ~( RANK_1 | RANK_2 | RANK_3 | RANK_4 ) ) );
+static_assert( passedPawnMask[BLACK_SIDE][A7] == ( ( FILE_A | FILE_B ) & ~( RANK_7 | RANK_8 ) ) );
+static_assert( passedPawnMask[WHITE_SIDE][H8] == 0 && passedPawnMask[BLACK_SIDE][H1] == 0 );
+
+// Sliders
+static_assert( GetRookAttacks( A1, 0 ) == ( ( FILE_A | RANK_1 ) & ~( 1ULL << A1 ) ) );
+static_assert( GetRookAttacks( D4, ( 1ULL << D6 ) | ( 1ULL << B4 ) ) ==
+               ( ( 1ULL << D5 ) | ( 1ULL << D6 ) | ( 1ULL << C4 ) | ( 1ULL << B4 ) | ( 1ULL << D3 ) | ( 1ULL << D2 ) |
+                 ( 1ULL << D1 ) | ( 1ULL << E4 ) | ( 1ULL << F4 ) | ( 1ULL << G4 ) | ( 1ULL << H4 ) ) );
+static_assert( GetBishopAttacks( C1, 1ULL << E3 ) ==
+               ( ( 1ULL << B2 ) | ( 1ULL << A3 ) | ( 1ULL << D2 ) | ( 1ULL << E3 ) ) );
+
 } // namespace Attacks
@@ -0,0 +1,253 @@
+#pragma once
+
+// ============================================================================
+// Batch Evaluation
+// ============================================================================
+// Static terms for many positions at once, for dataset scoring and tuning:
+// material with pair bonuses, piece-square tables, pawn structure and king
+// open files, tapered by game phase. Results are bit-identical to
+// Evaluator::EvaluateStaticTerms, which leaves out everything that needs
+// move generation (mobility, mate detection) or per-signature special cases
+// (draw flags, endgame scaling, specialized endgames).
+//
+// Positions are stored structure-of-arrays: one contiguous array of
+// bitboards per piece type, plus the board's incremental material and
+// piece-square score, so no table is walked square by square. With AVX2
+// four boards share each register and the remaining terms are computed with
+// bitboard fills and lane-wise popcounts; the last partial group, and builds
+// without AVX2, run the same formulas one board at a time. Every board must
+// have both kings.
+
+#include "bitboard.h"
+#include "board.h"
+#include "evaluate.h"
+#include "fills.h"
+#include "psqt.h"
+#include "score.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+
+namespace BatchEval {
+
+struct PositionBlock {
+    std::vector<uint64_t> pieces[12]; // [piece][board]
+    std::vector<Score> pieceSquare;   // [board], Board::material + Board::psqt
+
+    size_t Size() const { return pieceSquare.size(); }
+
+    void Add( const Board &board ) {
+        for ( int piece = 0; piece < 12; piece++ ) {
+            pieces[piece].push_back( board.bitboards[piece] );
+        }
+        pieceSquare.push_back( board.material + board.psqt );
+    }
+
+    void Clear() {
+        for ( auto &bitboards : pieces ) {
+            bitboards.clear();
+        }
+        pieceSquare.clear();
+    }
+};
+
+// ============================================================================
+// Scalar Path
+// ============================================================================
+
+// Static terms of one board of the block, white-relative
+inline int EvaluateOne( const PositionBlock &block, size_t index ) {
+    uint64_t bb[12];
+    int count[12];
+    for ( int piece = 0; piece < 12; piece++ ) {
+        bb[piece] = block.pieces[piece][index];
+        count[piece] = PopCount( bb[piece] );
+    }
+
+    // Material, piece-square tables and phase
+    Score total = block.pieceSquare[index];
+    int phase = 0;
+    for ( int piece = 0; piece < 12; piece++ ) {
+        phase += count[piece] * PSQT::PHASE_WEIGHTS[piece % 6];
+    }
+    total += MaterialTable::KNIGHT_PAIR * ( ( count[WN] >= 2 ) - ( count[BN] >= 2 ) );
+    total += MaterialTable::BISHOP_PAIR * ( ( count[WB] >= 2 ) - ( count[BB] >= 2 ) );
+
+    // Pawn structure: doubled pawns and isolated files from file sets
+    uint8_t whiteFiles = Fills::FileSet( bb[WP] );
+    uint8_t blackFiles = Fills::FileSet( bb[BP] );
+    total += Evaluator::DOUBLED_PAWN *
+             ( ( count[WP] - PopCount( whiteFiles ) ) - ( count[BP] - PopCount( blackFiles ) ) );
+    total += Evaluator::ISOLATED_PAWN *
+             ( PopCount( Fills::IsolatedFiles( whiteFiles ) ) - PopCount( Fills::IsolatedFiles( blackFiles ) ) );
+
+    uint64_t whitePassed = Fills::PassedPawns( bb[WP], bb[BP], true );
+    uint64_t blackPassed = Fills::PassedPawns( bb[BP], bb[WP], false );
+    for ( int rank = 1; rank < 7; rank++ ) {
+        uint64_t rankMask = RANK_1 << ( 8 * rank );
+        total += Evaluator::PASSED_PAWN_BONUS[rank] * PopCount( whitePassed & rankMask );
+        total -= Evaluator::PASSED_PAWN_BONUS[7 - rank] * PopCount( blackPassed & rankMask );
+    }
+
+    // King safety: files without own pawns on and next to the king's file
+    uint8_t whiteKing = Fills::FileSet( bb[WK] );
+    uint8_t blackKing = Fills::FileSet( bb[BK] );
+    uint8_t whiteArea = static_cast<uint8_t>( whiteKing | ( whiteKing << 1 ) | ( whiteKing >> 1 ) );
+    uint8_t blackArea = static_cast<uint8_t>( blackKing | ( blackKing << 1 ) | ( blackKing >> 1 ) );
+    total += Evaluator::KING_OPEN_FILE * ( PopCount( static_cast<uint8_t>( ~whiteFiles & whiteArea ) ) -
+                                           PopCount( static_cast<uint8_t>( ~blackFiles & blackArea ) ) );
+
+    return Taper( total, phase );
+}
+
+// ============================================================================
+// AVX2 Path
+// ============================================================================
+
+#if defined( __AVX2__ )
+
+namespace Simd {
+
+// Popcount of each 64-bit lane: nibble lookup, then byte sums
+inline __m256i PopCount( __m256i v ) {
+    const __m256i lookup = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1,
+                                             2, 2, 3, 2, 3, 3, 4 );
+    const __m256i nibble = _mm256_set1_epi8( 0x0F );
+    __m256i low = _mm256_shuffle_epi8( lookup, _mm256_and_si256( v, nibble ) );
+    __m256i high = _mm256_shuffle_epi8( lookup, _mm256_and_si256( _mm256_srli_epi16( v, 4 ), nibble ) );
+    return _mm256_sad_epu8( _mm256_add_epi8( low, high ), _mm256_setzero_si256() );
+}
+
+// Low 32 bits of each 64-bit lane, packed into 4 x int32
+inline __m128i Narrow( __m256i v ) {
+    return _mm256_castsi256_si128( _mm256_permutevar8x32_epi32( v, _mm256_setr_epi32( 0, 2, 4, 6, 0, 0, 0, 0 ) ) );
+}
+
+inline __m128i Count( __m256i v ) { return Narrow( PopCount( v ) ); }
+
+inline __m256i Set( uint64_t value ) { return _mm256_set1_epi64x( static_cast<long long>( value ) ); }
+
+inline __m256i SouthFill( __m256i b ) {
+    b = _mm256_or_si256( b, _mm256_srli_epi64( b, 8 ) );
+    b = _mm256_or_si256( b, _mm256_srli_epi64( b, 16 ) );
+    return _mm256_or_si256( b, _mm256_srli_epi64( b, 32 ) );
+}
+
+inline __m256i NorthFill( __m256i b ) {
+    b = _mm256_or_si256( b, _mm256_slli_epi64( b, 8 ) );
+    b = _mm256_or_si256( b, _mm256_slli_epi64( b, 16 ) );
+    return _mm256_or_si256( b, _mm256_slli_epi64( b, 32 ) );
+}
+
+inline __m256i WithAdjacentFiles( __m256i b ) {
+    __m256i east = _mm256_slli_epi64( _mm256_and_si256( b, Set( NOT_FILE_H ) ), 1 );
+    __m256i west = _mm256_srli_epi64( _mm256_and_si256( b, Set( NOT_FILE_A ) ), 1 );
+    return _mm256_or_si256( b, _mm256_or_si256( east, west ) );
+}
+
+// Neighbouring files of each file, for 8-bit file sets
+inline __m256i Neighbours( __m256i files ) {
+    return _mm256_or_si256( _mm256_slli_epi64( files, 1 ), _mm256_srli_epi64( files, 1 ) );
+}
+
+// total += score * count, lane-wise
+inline __m128i AddScaled( __m128i total, Score score, __m128i count ) {
+    return _mm_add_epi32( total, _mm_mullo_epi32( count, _mm_set1_epi32( score ) ) );
+}
+
+} // namespace Simd
+
+// Static terms of boards index .. index + 3
+inline void EvaluateFour( const PositionBlock &block, size_t index, int *out ) {
+    using namespace Simd;
+    const __m256i rank1 = Set( RANK_1 );
+
+    __m256i bb[12];
+    __m128i count[12];
+    for ( int piece = 0; piece < 12; piece++ ) {
+        bb[piece] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( &block.pieces[piece][index] ) );
+        count[piece] = Count( bb[piece] );
+    }
+
+    // Material, piece-square tables and phase
+    __m128i total = _mm_loadu_si128( reinterpret_cast<const __m128i *>( &block.pieceSquare[index] ) );
+    __m128i phase = _mm_setzero_si128();
+    for ( int piece = 0; piece < 12; piece++ ) {
+        phase = _mm_add_epi32( phase,
+                               _mm_mullo_epi32( count[piece], _mm_set1_epi32( PSQT::PHASE_WEIGHTS[piece % 6] ) ) );
+    }
+    const __m128i one = _mm_set1_epi32( 1 );
+    total = AddScaled( total, MaterialTable::KNIGHT_PAIR,
+                       _mm_sub_epi32( _mm_and_si128( _mm_cmpgt_epi32( count[WN], one ), one ),
+                                      _mm_and_si128( _mm_cmpgt_epi32( count[BN], one ), one ) ) );
+    total = AddScaled( total, MaterialTable::BISHOP_PAIR,
+                       _mm_sub_epi32( _mm_and_si128( _mm_cmpgt_epi32( count[WB], one ), one ),
+                                      _mm_and_si128( _mm_cmpgt_epi32( count[BB], one ), one ) ) );
+
+    // Pawn structure
+    __m256i whiteFiles = _mm256_and_si256( SouthFill( bb[WP] ), rank1 );
+    __m256i blackFiles = _mm256_and_si256( SouthFill( bb[BP] ), rank1 );
+    __m128i whiteFileCount = Count( whiteFiles );
+    __m128i blackFileCount = Count( blackFiles );
+    total = AddScaled( total, Evaluator::DOUBLED_PAWN,
+                       _mm_sub_epi32( _mm_sub_epi32( count[WP], whiteFileCount ),
+                                      _mm_sub_epi32( count[BP], blackFileCount ) ) );
+    total = AddScaled( total, Evaluator::ISOLATED_PAWN,
+                       _mm_sub_epi32( Count( _mm256_andnot_si256( Neighbours( whiteFiles ), whiteFiles ) ),
+                                      Count( _mm256_andnot_si256( Neighbours( blackFiles ), blackFiles ) ) ) );
+
+    __m256i whitePassed =
+        _mm256_andnot_si256( WithAdjacentFiles( SouthFill( _mm256_srli_epi64( bb[BP], 8 ) ) ), bb[WP] );
+    __m256i blackPassed =
+        _mm256_andnot_si256( WithAdjacentFiles( NorthFill( _mm256_slli_epi64( bb[WP], 8 ) ) ), bb[BP] );
+    for ( int rank = 1; rank < 7; rank++ ) {
+        __m256i rankMask = Set( RANK_1 << ( 8 * rank ) );
+        total = AddScaled( total, Evaluator::PASSED_PAWN_BONUS[rank],
+                           Count( _mm256_and_si256( whitePassed, rankMask ) ) );
+        total = AddScaled( total, -Evaluator::PASSED_PAWN_BONUS[7 - rank],
+                           Count( _mm256_and_si256( blackPassed, rankMask ) ) );
+    }
+
+    // King safety
+    __m256i whiteKing = _mm256_and_si256( SouthFill( bb[WK] ), rank1 );
+    __m256i blackKing = _mm256_and_si256( SouthFill( bb[BK] ), rank1 );
+    __m256i whiteArea = _mm256_and_si256( _mm256_or_si256( whiteKing, Neighbours( whiteKing ) ), rank1 );
+    __m256i blackArea = _mm256_and_si256( _mm256_or_si256( blackKing, Neighbours( blackKing ) ), rank1 );
+    total = AddScaled( total, Evaluator::KING_OPEN_FILE,
+                       _mm_sub_epi32( Count( _mm256_andnot_si256( whiteFiles, whiteArea ) ),
+                                      Count( _mm256_andnot_si256( blackFiles, blackArea ) ) ) );
+
+    // Taper, as in Taper(): mg * p + eg * (256 - p), shifted down
+    __m128i scale = _mm_i32gather_epi32( PHASE_SCALE.value, _mm_min_epi32( phase, _mm_set1_epi32( MAX_PHASE ) ), 4 );
+    __m128i mg = _mm_srai_epi32( _mm_slli_epi32( total, 16 ), 16 );
+    __m128i eg = _mm_srai_epi32( _mm_add_epi32( total, _mm_set1_epi32( 0x8000 ) ), 16 );
+    __m128i blended = _mm_add_epi32( _mm_mullo_epi32( mg, scale ),
+                                     _mm_mullo_epi32( eg, _mm_sub_epi32( _mm_set1_epi32( 256 ), scale ) ) );
+    _mm_storeu_si128( reinterpret_cast<__m128i *>( out + index ), _mm_srai_epi32( blended, 8 ) );
+}
+
+#endif
+
+// ============================================================================
+// Entry Point
+// ============================================================================
+
+// Static terms of every board in the block; out must hold block.Size() ints
+inline void Evaluate( const PositionBlock &block, int *out ) {
+    size_t size = block.Size();
+    size_t index = 0;
+#if defined( __AVX2__ )
+    for ( ; index + 4 <= size; index += 4 ) {
+        EvaluateFour( block, index, out );
+    }
+#endif
+    for ( ; index < size; index++ ) {
+        out[index] = EvaluateOne( block, index );
+    }
+}
+
+} // namespace BatchEval
@@ -0,0 +1,380 @@
+#pragma once
+
+#include "attacks.h"
+#include "bitboard.h"
+#include "board.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Endgame Bitbases
+// ============================================================================
+// Exact win/draw tables for KPK, KRK, KQK and KBNK at 1 bit per position,
+// generated in-process by retrograde analysis. A set bit means the side
+// with the material wins; the bare king can at best draw.
+//
+// Positions are stored with the strong side as white (black's are flipped
+// top to bottom) and indexed by side to move and the squares of the strong
+// king, the weak king and the one or two strong pieces, folded by symmetry
+// (see Position). KBNK takes 1 MB, KPK 32 KB, KQK and KRK 16 KB each.
+// Castling rights are ignored; the engine has no en passant.
+//
+// Generation starts from the mates (weak side to move, in check, no legal
+// move) and, for KPK, the promotions into won KQK or KRK positions. Wins
+// then spread backwards one ply per level: a strong-to-move position is
+// won once any move reaches a won position, a weak-to-move position once
+// all its moves do, counted down in a per-position byte. Each level's
+// frontier is split across threads, with atomic updates of the shared
+// position states. Whatever is never reached is a draw: a capture of the
+// last piece, a stalemate or an escape.
+
+namespace Bitbases {
+
+enum Outcome { UNKNOWN, WON, DRAWN };
+
+enum Ending { KQK, KRK, KPK, KBNK, ENDING_COUNT }; // Build order: KPK promotes into KQK and KRK
+
+// Strong side's pieces besides the king, as white piece indices
+constexpr int ENDING_PIECES[ENDING_COUNT][2] = { { WQ, -1 }, { WR, -1 }, { WP, -1 }, { WB, WN } };
+
+constexpr int PieceCount( Ending ending ) { return ENDING_PIECES[ending][1] < 0 ? 1 : 2; }
+
+// The strong king is folded into files a-d, and ranks 1-4 without pawns
+constexpr int KingBits( Ending ending ) { return ending == KPK ? 5 : 4; }
+
+constexpr size_t TableSize( Ending ending ) {
+    return size_t( 2 ) << ( KingBits( ending ) + 6 * ( 1 + PieceCount( ending ) ) );
+}
+
+// ============================================================================
+// Positions
+// ============================================================================
+// Mirroring the files, and flipping the ranks when there are no pawns, maps
+// no square onto itself, so each position has exactly one folded form and
+// no folded position is its own mirror image. That keeps the move counts of
+// the generator exact when moves are taken back from folded positions only.
+
+// Index bits: weak side to move (0), folded strong king, weak king, then 6
+// bits per piece
+struct Position {
+    bool weakToMove;
+    int strongKing;
+    int weakKing;
+    int pieces[2];
+
+    static Position Decode( Ending ending, size_t index ) {
+        int kingBits = KingBits( ending );
+        int king = static_cast<int>( index >> 1 & ( ( 1 << kingBits ) - 1 ) );
+        size_t rest = index >> ( 1 + kingBits );
+        return { ( index & 1 ) != 0,
+                 MakeSquare( king >> 2, king & 3 ),
+                 static_cast<int>( rest & 63 ),
+                 { static_cast<int>( rest >> 6 & 63 ), static_cast<int>( rest >> 12 & 63 ) } };
+    }
+
+    // Index of the folded position
+    size_t Encode( Ending ending ) const {
+        int fold = ( FileOf( strongKing ) > 3 ? 7 : 0 ) | ( ending != KPK && RankOf( strongKing ) > 3 ? 56 : 0 );
+        int king = strongKing ^ fold;
+        size_t index = size_t( RankOf( king ) * 4 + FileOf( king ) ) << 1 | size_t( weakToMove );
+        size_t rest = size_t( weakKing ^ fold ) | size_t( pieces[0] ^ fold ) << 6;
+        if ( PieceCount( ending ) == 2 )
+            rest |= size_t( pieces[1] ^ fold ) << 12;
+        return index | rest << ( 1 + KingBits( ending ) );
+    }
+};
+
+inline uint64_t PieceAttacks( int piece, int square, uint64_t occupied ) {
+    switch ( piece ) {
+    case WP:
+        return Attacks::pawnAttacks[WHITE_SIDE][square];
+    case WN:
+        return Attacks::knightAttacks[square];
+    case WB:
+        return Attacks::GetBishopAttacks( square, occupied );
+    case WR:
+        return Attacks::GetRookAttacks( square, occupied );
+    default:
+        return Attacks::GetQueenAttacks( square, occupied );
+    }
+}
+
+// ============================================================================
+// Generation
+// ============================================================================
+
+class Generator {
+  public:
+    using Bits = std::vector<uint64_t>;
+
+    // done holds the finished tables this ending converts into
+    Generator( Ending ending, const Bits *done, int threads )
+        : ending( ending ), pieceCount( PieceCount( ending ) ), size( TableSize( ending ) ), done( done ),
+          threads( threads ), state( new std::atomic<uint8_t>[size] ) {}
+
+    Bits Run() {
+        std::vector<std::vector<size_t>> found( threads );
+        Parallel( size, [&]( int thread, size_t begin, size_t end ) {
+            for ( size_t index = begin; index < end; index++ )
+                Initialize( index, found[thread] );
+        } );
+
+        std::vector<size_t> frontier = Merge( found );
+        while ( !frontier.empty() ) {
+            Parallel( frontier.size(), [&]( int thread, size_t begin, size_t end ) {
+                for ( size_t i = begin; i < end; i++ )
+                    Propagate( frontier[i], found[thread] );
+            } );
+            frontier = Merge( found );
+        }
+
+        Bits bits( size / 64 );
+        Parallel( bits.size(), [&]( int, size_t begin, size_t end ) {
+            for ( size_t word = begin; word < end; word++ ) {
+                for ( int bit = 0; bit < 64; bit++ ) {
+                    if ( state[word * 64 + bit].load( std::memory_order_relaxed ) == WIN )
+                        bits[word] |= 1ULL << bit;
+                }
+            }
+        } );
+        return bits;
+    }
+
+  private:
+    // Per-position state: WIN, NONE for illegal and drawn positions, else
+    // PENDING (strong to move) or the weak side's count of unrefuted moves
+    static constexpr uint8_t WIN = 0;
+    static constexpr uint8_t PENDING = 1;
+    static constexpr uint8_t NONE = 0xFF;
+
+    Ending ending;
+    int pieceCount;
+    size_t size;
+    const Bits *done;
+    int threads;
+    std::unique_ptr<std::atomic<uint8_t>[]> state;
+
+    template <typename Body> void Parallel( size_t count, Body body ) const {
+        std::vector<std::thread> workers;
+        size_t chunk = ( count + threads - 1 ) / threads;
+        for ( int t = 0; t < threads; t++ ) {
+            size_t begin = std::min( count, t * chunk ), end = std::min( count, begin + chunk );
+            workers.emplace_back( [&body, t, begin, end] { body( t, begin, end ); } );
+        }
+        for ( auto &worker : workers )
+            worker.join();
+    }
+
+    static std::vector<size_t> Merge( std::vector<std::vector<size_t>> &found ) {
+        std::vector<size_t> merged;
+        for ( auto &part : found ) {
+            merged.insert( merged.end(), part.begin(), part.end() );
+            part.clear();
+        }
+        return merged;
+    }
+
+    uint64_t PieceMask( const Position &position ) const {
+        uint64_t mask = 1ULL << position.pieces[0];
+        return pieceCount == 2 ? mask | 1ULL << position.pieces[1] : mask;
+    }
+
+    // Squares the strong side attacks, without the piece on skip (a capture)
+    uint64_t StrongAttacks( const Position &position, uint64_t occupied, int skip = -1 ) const {
+        uint64_t attacked = Attacks::kingAttacks[position.strongKing];
+        for ( int i = 0; i < pieceCount; i++ ) {
+            if ( position.pieces[i] != skip )
+                attacked |= PieceAttacks( ENDING_PIECES[ending][i], position.pieces[i], occupied );
+        }
+        return attacked;
+    }
+
+    bool IsLegal( const Position &position ) const {
+        uint64_t occupied = 1ULL << position.strongKing | 1ULL << position.weakKing;
+        for ( int i = 0; i < pieceCount; i++ ) {
+            int square = position.pieces[i];
+            if ( occupied & 1ULL << square )
+                return false;
+            if ( ENDING_PIECES[ending][i] == WP && ( square < A2 || square > H7 ) )
+                return false;
+            occupied |= 1ULL << square;
+        }
+        if ( Attacks::kingAttacks[position.strongKing] & 1ULL << position.weakKing )
+            return false;
+        return position.weakToMove || !( StrongAttacks( position, occupied ) & 1ULL << position.weakKing );
+    }
+
+    void Initialize( size_t index, std::vector<size_t> &found ) {
+        Position position = Position::Decode( ending, index );
+        if ( !IsLegal( position ) ) {
+            state[index].store( NONE, std::memory_order_relaxed );
+            return;
+        }
+
+        uint8_t initial;
+        if ( position.weakToMove )
+            initial = WeakMoveCount( position );
+        else
+            initial = WinsByPromotion( position ) ? WIN : PENDING;
+        state[index].store( initial, std::memory_order_relaxed );
+        if ( initial == WIN )
+            found.push_back( index );
+    }
+
+    // Legal replies of the bare king, captures included; 0 means mated, and
+    // NONE stalemated
+    uint8_t WeakMoveCount( const Position &position ) const {
+        uint64_t pieces = PieceMask( position );
+        uint64_t occupied = pieces | 1ULL << position.strongKing; // The weak king does not shield its own escape
+        uint64_t attacked = StrongAttacks( position, occupied );
+        uint64_t targets = Attacks::kingAttacks[position.weakKing] & ~attacked;
+        int count = PopCount( targets & ~pieces );
+
+        uint64_t captures = Attacks::kingAttacks[position.weakKing] & pieces;
+        while ( captures ) {
+            int to = PopLSB( captures );
+            count += !( StrongAttacks( position, occupied & ~( 1ULL << to ), to ) & 1ULL << to );
+        }
+        if ( count > 0 )
+            return static_cast<uint8_t>( count );
+        return attacked & 1ULL << position.weakKing ? WIN : NONE;
+    }
+
+    // A promotion to a queen or rook that reaches a won KQK or KRK position
+    bool WinsByPromotion( const Position &position ) const {
+        if ( ending != KPK || position.pieces[0] < A7 )
+            return false;
+        int to = position.pieces[0] + 8;
+        if ( to == position.strongKing || to == position.weakKing )
+            return false;
+        Position promoted = position;
+        promoted.weakToMove = true;
+        promoted.pieces[0] = to;
+        size_t index = promoted.Encode( KQK ); // KRK folds the same way
+        return ( done[KQK][index / 64] >> ( index % 64 ) & 1 ) || ( done[KRK][index / 64] >> ( index % 64 ) & 1 );
+    }
+
+    // A newly won position: every position one move before it is visited
+    void Propagate( size_t index, std::vector<size_t> &found ) {
+        Position position = Position::Decode( ending, index );
+        uint64_t occupied = PieceMask( position ) | 1ULL << position.strongKing | 1ULL << position.weakKing;
+
+        if ( !position.weakToMove ) {
+            // The weak king moved last: its count of unrefuted moves drops
+            uint64_t from = Attacks::kingAttacks[position.weakKing] & ~occupied &
+                            ~Attacks::kingAttacks[position.strongKing];
+            while ( from ) {
+                Position previous = position;
+                previous.weakToMove = true;
+                previous.weakKing = PopLSB( from );
+                size_t before = previous.Encode( ending );
+                if ( state[before].fetch_sub( 1, std::memory_order_relaxed ) == 1 )
+                    found.push_back( before );
+            }
+            return;
+        }
+
+        // The strong side moved last: any position it moved from is won
+        Position previous = position;
+        previous.weakToMove = false;
+        auto markWon = [&]() {
+            size_t before = previous.Encode( ending );
+            uint8_t expected = PENDING;
+            if ( state[before].load( std::memory_order_relaxed ) == PENDING &&
+                 state[before].compare_exchange_strong( expected, WIN, std::memory_order_relaxed ) )
+                found.push_back( before );
+        };
+
+        uint64_t from = Attacks::kingAttacks[position.strongKing] & ~occupied;
+        while ( from ) {
+            previous.strongKing = PopLSB( from );
+            markWon();
+        }
+        previous.strongKing = position.strongKing;
+
+        for ( int i = 0; i < pieceCount; i++ ) {
+            int piece = ENDING_PIECES[ending][i], square = position.pieces[i];
+            if ( piece == WP ) {
+                from = square >= A3 && !( occupied & 1ULL << ( square - 8 ) ) ? 1ULL << ( square - 8 ) : 0;
+                if ( from && square >= A4 && square <= H4 && !( occupied & 1ULL << ( square - 16 ) ) )
+                    from |= 1ULL << ( square - 16 );
+            } else {
+                from = PieceAttacks( piece, square, occupied ) & ~occupied;
+            }
+            while ( from ) {
+                previous.pieces[i] = PopLSB( from );
+                markWon();
+            }
+            previous.pieces[i] = square;
+        }
+    }
+};
+
+// ============================================================================
+// Tables and Probing
+// ============================================================================
+
+struct Tables {
+    Generator::Bits bits[ENDING_COUNT];
+};
+
+inline Tables Build( int threads ) {
+    Tables tables;
+    for ( int ending = 0; ending < ENDING_COUNT; ending++ )
+        tables.bits[ending] = Generator( static_cast<Ending>( ending ), tables.bits, threads ).Run();
+    return tables;
+}
+
+// Built on first use; function-local statics are initialized thread-safely
+inline const Tables &Data( int threads = 0 ) {
+    static const Tables tables =
+        Build( threads > 0 ? threads : std::max( 1, static_cast<int>( std::thread::hardware_concurrency() ) ) );
+    return tables;
+}
+
+// Builds the tables now, so no search pays for it on its first probe;
+// later calls return at once
+inline void Init( int threads = 0 ) { Data( threads ); }
+
+// Exact result for the side with the material, or UNKNOWN for positions
+// outside the four endings
+inline Outcome Probe( const Board &board ) {
+    uint64_t occupied = board.occupancies[2];
+    if ( PopCount( occupied ) > 4 || PopCount( occupied ) < 3 )
+        return UNKNOWN;
+    bool whiteBare = board.occupancies[0] == board.bitboards[WK];
+    bool blackBare = board.occupancies[1] == board.bitboards[BK];
+    if ( whiteBare == blackBare )
+        return UNKNOWN;
+
+    bool strongWhite = blackBare;
+    const uint8_t *count = board.pieceCount + ( strongWhite ? 0 : 6 );
+    int pieces = PopCount( occupied ) - 2;
+    Ending ending;
+    if ( pieces == 1 && count[WP] )
+        ending = KPK;
+    else if ( pieces == 1 && count[WR] )
+        ending = KRK;
+    else if ( pieces == 1 && count[WQ] )
+        ending = KQK;
+    else if ( pieces == 2 && count[WB] == 1 && count[WN] == 1 )
+        ending = KBNK;
+    else
+        return UNKNOWN;
+
+    int flip = strongWhite ? 0 : 56;
+    int base = strongWhite ? 0 : 6;
+    Position position{ board.whiteToMove != strongWhite, BitScanForward( board.bitboards[base + WK] ) ^ flip,
+                       BitScanForward( board.bitboards[6 - base + WK] ) ^ flip, { 0, 0 } };
+    for ( int i = 0; i < PieceCount( ending ); i++ )
+        position.pieces[i] = BitScanForward( board.bitboards[base + ENDING_PIECES[ending][i]] ) ^ flip;
+
+    size_t index = position.Encode( ending );
+    return Data().bits[ending][index / 64] >> ( index % 64 ) & 1 ? WON : DRAWN;
+}
+
+} // namespace Bitbases
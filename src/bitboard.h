@@ -124,3 +124,46 @@ inline constexpr int RankOf( int sq ) { return sq / 8; }
 
 // Extract file from square
 inline constexpr int FileOf( int sq ) { return sq % 8; }
+
+// Shift by a compile-time offset: positive toward h8, negative toward a1
+template <int Offset> inline constexpr uint64_t Shift( uint64_t bb ) {
+    if constexpr ( Offset > 0 )
+        return bb << Offset;
+    else
+        return bb >> -Offset;
+}
+
+// ============================================================================
+// Color Traits
+// ============================================================================
+// Everything that differs between the two sides, as compile-time constants,
+// for code templated on the side to move. Offsets are from that side's view.
+
+template <bool White> struct ColorTraits {
+    static constexpr int US = White ? WHITE_SIDE : BLACK_SIDE;
+    static constexpr int THEM = White ? BLACK_SIDE : WHITE_SIDE;
+
+    static constexpr int PAWN = White ? WP : BP;
+    static constexpr int KNIGHT = White ? WN : BN;
+    static constexpr int BISHOP = White ? WB : BB;
+    static constexpr int ROOK = White ? WR : BR;
+    static constexpr int QUEEN = White ? WQ : BQ;
+    static constexpr int KING = White ? WK : BK;
+
+    static constexpr int UP = White ? 8 : -8;
+    static constexpr int UP_LEFT = White ? 7 : -9;  // Capture toward the a-file
+    static constexpr int UP_RIGHT = White ? 9 : -7; // Capture toward the h-file
+
+    static constexpr uint64_t DOUBLE_PUSH_RANK = White ? RANK_3 : RANK_6; // After the first step
+    static constexpr uint64_t PROMOTION_RANK = White ? RANK_8 : RANK_1;
+
+    static constexpr uint8_t CASTLE_KINGSIDE = White ? CASTLE_WK : CASTLE_BK;
+    static constexpr uint8_t CASTLE_QUEENSIDE = White ? CASTLE_WQ : CASTLE_BQ;
+    static constexpr int KING_START = White ? E1 : E8;
+    static constexpr int KINGSIDE_TARGET = White ? G1 : G8;
+    static constexpr int QUEENSIDE_TARGET = White ? C1 : C8;
+    static constexpr int KINGSIDE_ROOK_FROM = White ? H1 : H8;
+    static constexpr int KINGSIDE_ROOK_TO = White ? F1 : F8;
+    static constexpr int QUEENSIDE_ROOK_FROM = White ? A1 : A8;
+    static constexpr int QUEENSIDE_ROOK_TO = White ? D1 : D8;
+};
@@ -3,16 +3,52 @@
 #include "attacks.h"
 #include "bitboard.h"
 #include "move.h"
+#include "psqt.h"
+#include "zobrist.h"
+#include <array>
 #include <bitset>
+#include <cassert>
 #include <iostream>
 #include <string>
-#include <unordered_map>
+#include <type_traits>
+
+// ============================================================================
+// Static Piece Tables
+// ============================================================================
+
+// FEN letter of each piece, indexed by Piece
+inline constexpr char PIECE_CHARS[] = "PNBRQKpnbrqk";
+
+// Piece for each ASCII character, NO_PIECE for anything else
+inline constexpr std::array<int8_t, 128> PIECE_FROM_CHAR = [] {
+    std::array<int8_t, 128> table{};
+    for ( auto &entry : table )
+        entry = NO_PIECE;
+    for ( int piece = WP; piece <= BK; piece++ )
+        table[PIECE_CHARS[piece]] = static_cast<int8_t>( piece );
+    return table;
+}();
+
+inline constexpr int PieceFromChar( char c ) {
+    return static_cast<unsigned char>( c ) < 128 ? PIECE_FROM_CHAR[c] : static_cast<int>( NO_PIECE );
+}
+
+inline constexpr std::array<int8_t, 64> EMPTY_MAILBOX = [] {
+    std::array<int8_t, 64> mailbox{};
+    for ( auto &square : mailbox )
+        square = NO_PIECE;
+    return mailbox;
+}();
 
 // ============================================================================
 // Board - Position State Only
 // ============================================================================
 // This class manages the board state: piece positions, castling rights, turn.
 // Move generation and game logic are handled by separate modules.
+//
+// Board is a plain, trivially copyable value with no heap storage, so it can
+// be copied with memcpy for per-thread copies and copy-make search. The NNUE
+// accumulators are kept out of it, in the search's NNUE::AccumulatorStack.
 
 class Board {
   public:
@@ -22,19 +58,21 @@ class Board {
 
     uint64_t bitboards[12] = { 0 };  // 6 piece types × 2 colors
     uint64_t occupancies[3] = { 0 }; // [0]=white, [1]=black, [2]=all
+    std::array<int8_t, 64> mailbox = EMPTY_MAILBOX; // Piece on each square, NO_PIECE if empty
     bool whiteToMove = true;
     uint8_t castlingRights = CASTLE_ALL;
 
-    // Piece character to index mapping
-    std::unordered_map<char, Piece> pieceMap = { { 'P', WP }, { 'N', WN }, { 'B', WB }, { 'R', WR },
-                                                 { 'Q', WQ }, { 'K', WK }, { 'p', BP }, { 'n', BN },
-                                                 { 'b', BB }, { 'r', BR }, { 'q', BQ }, { 'k', BK } };
+    // Incrementally updated evaluation terms (white minus black)
+    Score material = SCORE_ZERO;    // Weighted piece values, no pair bonuses
+    Score psqt = SCORE_ZERO;        // Weighted piece-square score
+    int gamePhase = 0;              // Sum of PSQT::PHASE_WEIGHTS, MAX_PHASE at the start
+    uint8_t pieceCount[12] = { 0 }; // Population count of each bitboard
+    uint32_t materialKey = 0;       // Sum of PSQT::MATERIAL_KEY_WEIGHTS, indexes the material table
 
-    // ========================================================================
-    // Construction
-    // ========================================================================
-
-    Board() { Attacks::Init(); }
+    // Zobrist keys: whole position (pieces, side to move, castling rights)
+    // and the pawns alone, for the pawn-structure hash table
+    uint64_t hashKey = 0;
+    uint64_t pawnKey = 0;
 
     // ========================================================================
     // FEN Loading
@@ -55,14 +93,42 @@ class Board {
                 file += c - '0';
             } else {
                 int square = rank * 8 + file;
-                if ( pieceMap.count( c ) ) {
-                    bitboards[pieceMap[c]] |= ( 1ULL << square );
+                int piece = PieceFromChar( c );
+                if ( piece != NO_PIECE ) {
+                    bitboards[piece] |= ( 1ULL << square );
                 }
                 file++;
             }
             index++;
         }
+
+        // Side to move and castling rights, when the FEN has them
+        if ( index + 1 < fen.size() ) {
+            whiteToMove = fen[++index] != 'b';
+            index += 2;
+        }
+        if ( index < fen.size() ) {
+            castlingRights = 0;
+            for ( ; index < fen.size() && fen[index] != ' '; index++ ) {
+                switch ( fen[index] ) {
+                case 'K':
+                    castlingRights |= CASTLE_WK;
+                    break;
+                case 'Q':
+                    castlingRights |= CASTLE_WQ;
+                    break;
+                case 'k':
+                    castlingRights |= CASTLE_BK;
+                    break;
+                case 'q':
+                    castlingRights |= CASTLE_BQ;
+                    break;
+                }
+            }
+        }
+
         UpdateOccupancies();
+        RefreshAccumulators();
     }
 
     void Reset() {
@@ -91,130 +157,216 @@ class Board {
     }
 
     // ========================================================================
-    // Make Move
+    // Piece Placement
     // ========================================================================
+    // All bitboard edits in MakeMove/UndoMove go through these so that the
+    // evaluation accumulators and hash keys stay in sync. Occupancies are not
+    // touched.
+
+    void AddPiece( int piece, int square ) {
+        bitboards[piece] |= 1ULL << square;
+        mailbox[square] = static_cast<int8_t>( piece );
+        material += PSQT::PACKED.material[piece];
+        psqt += PSQT::PACKED.psqt[piece][square];
+        gamePhase += PSQT::PHASE_WEIGHTS[piece % 6];
+        pieceCount[piece]++;
+        materialKey += PSQT::MATERIAL_KEY_WEIGHTS[piece];
+        hashKey ^= Zobrist::KEYS.pieceSquare[piece][square];
+        pawnKey ^= Zobrist::KEYS.pawnSquare[piece][square];
+    }
 
-    void MakeMove( Move &move ) {
-        uint64_t fromMask = 1ULL << move.fromSquare;
-        uint64_t toMask = 1ULL << move.toSquare;
+    void RemovePiece( int piece, int square ) {
+        bitboards[piece] &= ~( 1ULL << square );
+        mailbox[square] = NO_PIECE;
+        material -= PSQT::PACKED.material[piece];
+        psqt -= PSQT::PACKED.psqt[piece][square];
+        gamePhase -= PSQT::PHASE_WEIGHTS[piece % 6];
+        pieceCount[piece]--;
+        materialKey -= PSQT::MATERIAL_KEY_WEIGHTS[piece];
+        hashKey ^= Zobrist::KEYS.pieceSquare[piece][square];
+        pawnKey ^= Zobrist::KEYS.pawnSquare[piece][square];
+    }
+
+    void MovePiece( int piece, int from, int to ) {
+        bitboards[piece] ^= ( 1ULL << from ) | ( 1ULL << to );
+        mailbox[from] = NO_PIECE;
+        mailbox[to] = static_cast<int8_t>( piece );
+        psqt += PSQT::PACKED.psqt[piece][to] - PSQT::PACKED.psqt[piece][from];
+        hashKey ^= Zobrist::KEYS.pieceSquare[piece][from] ^ Zobrist::KEYS.pieceSquare[piece][to];
+        pawnKey ^= Zobrist::KEYS.pawnSquare[piece][from] ^ Zobrist::KEYS.pawnSquare[piece][to];
+    }
 
+    // ========================================================================
+    // Evaluation Accumulators
+    // ========================================================================
+
+    // Recompute every accumulator and key from scratch
+    void RefreshAccumulators() {
+        material = psqt = SCORE_ZERO;
+        gamePhase = 0;
+        materialKey = 0;
+        hashKey = StateKey();
+        pawnKey = 0;
+        mailbox = EMPTY_MAILBOX;
+        for ( int piece = 0; piece < 12; ++piece ) {
+            pieceCount[piece] = 0;
+            uint64_t pieces = bitboards[piece];
+            while ( pieces ) {
+                int square = PopLSB( pieces );
+                mailbox[square] = static_cast<int8_t>( piece );
+                material += PSQT::PACKED.material[piece];
+                psqt += PSQT::PACKED.psqt[piece][square];
+                gamePhase += PSQT::PHASE_WEIGHTS[piece % 6];
+                pieceCount[piece]++;
+                materialKey += PSQT::MATERIAL_KEY_WEIGHTS[piece];
+                hashKey ^= Zobrist::KEYS.pieceSquare[piece][square];
+                pawnKey ^= Zobrist::KEYS.pawnSquare[piece][square];
+            }
+        }
+    }
+
+    // Debug check: do the incremental accumulators, keys and mailbox match a full rescan?
+    bool AccumulatorsConsistent() const {
+        Score freshMaterial = SCORE_ZERO, freshPsqt = SCORE_ZERO;
+        int freshPhase = 0;
+        uint32_t freshMaterialKey = 0;
+        uint64_t freshHashKey = StateKey();
+        uint64_t freshPawnKey = 0;
+        for ( int piece = 0; piece < 12; ++piece ) {
+            if ( PopCount( bitboards[piece] ) != pieceCount[piece] )
+                return false;
+
+            uint64_t pieces = bitboards[piece];
+            while ( pieces ) {
+                int square = PopLSB( pieces );
+                if ( mailbox[square] != piece )
+                    return false;
+                freshMaterial += PSQT::PACKED.material[piece];
+                freshPsqt += PSQT::PACKED.psqt[piece][square];
+                freshPhase += PSQT::PHASE_WEIGHTS[piece % 6];
+                freshMaterialKey += PSQT::MATERIAL_KEY_WEIGHTS[piece];
+                freshHashKey ^= Zobrist::KEYS.pieceSquare[piece][square];
+                freshPawnKey ^= Zobrist::KEYS.pawnSquare[piece][square];
+            }
+        }
+        int mailboxPieces = 0;
+        for ( int8_t piece : mailbox )
+            mailboxPieces += piece != NO_PIECE;
+        if ( mailboxPieces != PopCount( occupancies[2] ) )
+            return false;
+
+        return freshMaterial == material && freshPsqt == psqt && freshPhase == gamePhase &&
+               freshMaterialKey == materialKey && freshHashKey == hashKey && freshPawnKey == pawnKey;
+    }
+
+    // Key contribution of the side to move and castling rights
+    uint64_t StateKey() const {
+        return Zobrist::KEYS.castling[castlingRights] ^ ( whiteToMove ? 0ULL : Zobrist::KEYS.sideToMove );
+    }
+
+    // ========================================================================
+    // Make Move
+    // ========================================================================
+    // Specialized on the side to move, which must equal whiteToMove
+
+    template <bool White> void MakeMove( Move &move ) {
+        using Us = ColorTraits<White>;
+        assert( White == whiteToMove );
         // Store previous state for undo
-        move.previousWhiteToMove = whiteToMove;
+        move.previousWhiteToMove = White;
         move.previousCastlingRights = castlingRights;
         move.capturedPieceType = NO_PIECE;
 
-        // Update castling rights if king or rook moves
+        // Update castling rights if king or rook moves, or a rook is captured at home
         if ( move.fromSquare == E1 )
             castlingRights &= ~( CASTLE_WK | CASTLE_WQ );
-        if ( move.fromSquare == H1 )
+        if ( move.fromSquare == H1 || move.toSquare == H1 )
             castlingRights &= ~CASTLE_WK;
-        if ( move.fromSquare == A1 )
+        if ( move.fromSquare == A1 || move.toSquare == A1 )
             castlingRights &= ~CASTLE_WQ;
         if ( move.fromSquare == E8 )
             castlingRights &= ~( CASTLE_BK | CASTLE_BQ );
-        if ( move.fromSquare == H8 )
+        if ( move.fromSquare == H8 || move.toSquare == H8 )
             castlingRights &= ~CASTLE_BK;
-        if ( move.fromSquare == A8 )
+        if ( move.fromSquare == A8 || move.toSquare == A8 )
             castlingRights &= ~CASTLE_BQ;
 
         // Remove captured piece
-        for ( int i = 0; i < 12; i++ ) {
-            if ( bitboards[i] & toMask ) {
-                move.capturedPieceType = i;
-                bitboards[i] &= ~toMask;
-                break;
-            }
+        if ( mailbox[move.toSquare] != NO_PIECE ) {
+            move.capturedPieceType = mailbox[move.toSquare];
+            RemovePiece( move.capturedPieceType, move.toSquare );
         }
 
         // Handle promotion
         if ( move.isPromotion && move.promotedPiece != NO_PIECE ) {
-            int pawnIndex = whiteToMove ? WP : BP;
-            bitboards[pawnIndex] &= ~fromMask;
-            bitboards[move.promotedPiece] |= toMask;
+            RemovePiece( Us::PAWN, move.fromSquare );
+            AddPiece( move.promotedPiece, move.toSquare );
         }
         // Handle castling
         else if ( move.isCastling ) {
-            int kingIndex = whiteToMove ? WK : BK;
-            int rookIndex = whiteToMove ? WR : BR;
-
-            bitboards[kingIndex] ^= fromMask | toMask;
-
-            if ( whiteToMove ) {
-                if ( move.toSquare == G1 ) {
-                    bitboards[rookIndex] ^= ( 1ULL << H1 ) | ( 1ULL << F1 );
-                    move.rookFrom = H1;
-                    move.rookTo = F1;
-                } else {
-                    bitboards[rookIndex] ^= ( 1ULL << A1 ) | ( 1ULL << D1 );
-                    move.rookFrom = A1;
-                    move.rookTo = D1;
-                }
+            MovePiece( Us::KING, move.fromSquare, move.toSquare );
+
+            if ( move.toSquare == Us::KINGSIDE_TARGET ) {
+                move.rookFrom = Us::KINGSIDE_ROOK_FROM;
+                move.rookTo = Us::KINGSIDE_ROOK_TO;
             } else {
-                if ( move.toSquare == G8 ) {
-                    bitboards[rookIndex] ^= ( 1ULL << H8 ) | ( 1ULL << F8 );
-                    move.rookFrom = H8;
-                    move.rookTo = F8;
-                } else {
-                    bitboards[rookIndex] ^= ( 1ULL << A8 ) | ( 1ULL << D8 );
-                    move.rookFrom = A8;
-                    move.rookTo = D8;
-                }
+                move.rookFrom = Us::QUEENSIDE_ROOK_FROM;
+                move.rookTo = Us::QUEENSIDE_ROOK_TO;
             }
+            MovePiece( Us::ROOK, move.rookFrom, move.rookTo );
             move.isRookMove = true;
         }
         // Regular move
         else {
-            for ( int i = 0; i < 12; i++ ) {
-                if ( bitboards[i] & fromMask ) {
-                    bitboards[i] ^= fromMask | toMask;
-                    break;
-                }
-            }
+            MovePiece( mailbox[move.fromSquare], move.fromSquare, move.toSquare );
         }
 
-        whiteToMove = !whiteToMove;
+        hashKey ^= Zobrist::KEYS.castling[move.previousCastlingRights] ^ Zobrist::KEYS.castling[castlingRights];
+        hashKey ^= Zobrist::KEYS.sideToMove;
+
+        whiteToMove = !White;
         UpdateOccupancies();
     }
 
+    void MakeMove( Move &move ) { whiteToMove ? MakeMove<true>( move ) : MakeMove<false>( move ); }
+
     // ========================================================================
     // Undo Move
     // ========================================================================
+    // Specialized on the side that made the move
 
-    void UndoMove( const Move &move ) {
-        uint64_t fromMask = 1ULL << move.fromSquare;
-        uint64_t toMask = 1ULL << move.toSquare;
-
-        whiteToMove = move.previousWhiteToMove;
+    template <bool White> void UndoMove( const Move &move ) {
+        using Us = ColorTraits<White>;
+        assert( White != whiteToMove );
+        whiteToMove = White;
 
         if ( move.isPromotion && move.promotedPiece != NO_PIECE ) {
-            bitboards[move.promotedPiece] &= ~toMask;
-            int pawnIndex = whiteToMove ? WP : BP;
-            bitboards[pawnIndex] |= fromMask;
+            RemovePiece( move.promotedPiece, move.toSquare );
+            AddPiece( Us::PAWN, move.fromSquare );
         } else if ( move.isCastling ) {
-            int kingIndex = whiteToMove ? WK : BK;
-            int rookIndex = whiteToMove ? WR : BR;
-
-            bitboards[kingIndex] ^= fromMask | toMask;
             if ( move.isRookMove ) {
-                bitboards[rookIndex] ^= ( 1ULL << move.rookFrom ) | ( 1ULL << move.rookTo );
+                MovePiece( Us::ROOK, move.rookTo, move.rookFrom );
             }
+            MovePiece( Us::KING, move.toSquare, move.fromSquare );
         } else {
-            for ( int i = 0; i < 12; i++ ) {
-                if ( bitboards[i] & toMask ) {
-                    bitboards[i] ^= fromMask | toMask;
-                    break;
-                }
-            }
+            MovePiece( mailbox[move.toSquare], move.toSquare, move.fromSquare );
         }
 
         if ( move.capturedPieceType != NO_PIECE ) {
-            bitboards[move.capturedPieceType] |= toMask;
+            AddPiece( move.capturedPieceType, move.toSquare );
         }
 
+        hashKey ^= Zobrist::KEYS.castling[castlingRights] ^ Zobrist::KEYS.castling[move.previousCastlingRights];
+        hashKey ^= Zobrist::KEYS.sideToMove;
+
         castlingRights = move.previousCastlingRights;
         UpdateOccupancies();
     }
 
+    void UndoMove( const Move &move ) {
+        move.previousWhiteToMove ? UndoMove<true>( move ) : UndoMove<false>( move );
+    }
+
     // ========================================================================
     // Debug
     // ========================================================================
@@ -238,6 +390,8 @@ class Board {
     }
 };
 
+static_assert( std::is_trivially_copyable<Board>::value, "Board must stay a plain value for copy-make" );
+
 // ============================================================================
 // Include implementations that depend on Board
 // ============================================================================
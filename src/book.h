@@ -0,0 +1,155 @@
+#pragma once
+
+#include "board.h"
+#include "game_state.h"
+#include "move.h"
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// ============================================================================
+// Opening Book
+// ============================================================================
+// A sorted array of 16-byte big-endian entries in the Polyglot layout: key
+// (8 bytes), move (2), weight (2), learn (4). Entries are sorted by key and,
+// within a key, by weight descending. The file is memory-mapped and probed
+// by binary search, so opening costs nothing however large the book is and
+// only the pages a probe touches are read.
+//
+// The keys are the engine's own Zobrist keys (zobrist.h), not the Polyglot
+// Random64 table, so books from tools/make_book.cpp and third-party .bin
+// books are not interchangeable even though the layout matches.
+//
+// Move bits: to file 0-2, to rank 3-5, from file 6-8, from rank 9-11,
+// promotion 12-14 (1 knight .. 4 queen). Castling is written king takes
+// own rook (e1h1), as Polyglot does.
+
+class OpeningBook {
+  public:
+    static constexpr size_t ENTRY_BYTES = 16;
+
+    struct Entry {
+        uint64_t key;
+        uint16_t move;
+        uint16_t weight;
+        uint32_t learn;
+    };
+
+    OpeningBook() = default;
+    OpeningBook( const OpeningBook & ) = delete;
+    OpeningBook &operator=( const OpeningBook & ) = delete;
+    ~OpeningBook() { Close(); }
+
+    // Maps the file read-only; false if it is missing, empty or not a whole
+    // number of entries
+    bool Open( const std::string &path ) {
+        Close();
+        int fd = open( path.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            return false;
+        struct stat info;
+        if ( fstat( fd, &info ) == 0 && info.st_size > 0 && info.st_size % ENTRY_BYTES == 0 ) {
+            void *mapped = mmap( nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( mapped != MAP_FAILED ) {
+                madvise( mapped, info.st_size, MADV_RANDOM );
+                data = static_cast<const uint8_t *>( mapped );
+                bytes = static_cast<size_t>( info.st_size );
+            }
+        }
+        close( fd ); // The mapping outlives the descriptor
+        return data != nullptr;
+    }
+
+    void Close() {
+        if ( data )
+            munmap( const_cast<uint8_t *>( data ), bytes );
+        data = nullptr;
+        bytes = 0;
+    }
+
+    bool IsOpen() const { return data != nullptr; }
+    size_t Size() const { return bytes / ENTRY_BYTES; }
+
+    // Every entry for key, highest weight first
+    void Lookup( uint64_t key, std::vector<Entry> &entries ) const {
+        entries.clear();
+        size_t low = 0, high = Size();
+        while ( low < high ) { // First entry with a key >= key
+            size_t middle = low + ( high - low ) / 2;
+            if ( ReadEntry( middle ).key < key )
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        for ( ; low < Size(); low++ ) {
+            Entry entry = ReadEntry( low );
+            if ( entry.key != key )
+                break;
+            entries.push_back( entry );
+        }
+    }
+
+    // The highest-weight book move that is legal here; entries for moves
+    // that are not (a key collision or a damaged book) are skipped
+    bool Probe( Board &board, Move &move ) const {
+        if ( !data )
+            return false;
+        std::vector<Entry> entries;
+        Lookup( board.hashKey, entries );
+        if ( entries.empty() )
+            return false;
+
+        std::vector<Move> legal;
+        GameState::GenerateAllLegalMoves( board, legal, board.whiteToMove );
+        for ( const Entry &entry : entries ) {
+            for ( const Move &candidate : legal ) {
+                if ( entry.weight > 0 && EncodeMove( candidate ) == entry.move ) {
+                    move = candidate;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static uint16_t EncodeMove( const Move &move ) {
+        int to = move.toSquare;
+        if ( move.isCastling )
+            to = to > move.fromSquare ? move.fromSquare + 3 : move.fromSquare - 4; // The rook's square
+        int promotion = move.isPromotion ? move.promotedPiece % 6 : 0; // Knight 1 .. queen 4
+        return static_cast<uint16_t>( ( to % 8 ) | ( to / 8 ) << 3 | ( move.fromSquare % 8 ) << 6 |
+                                      ( move.fromSquare / 8 ) << 9 | promotion << 12 );
+    }
+
+    static void WriteEntry( const Entry &entry, uint8_t *out ) {
+        for ( int i = 0; i < 8; i++ )
+            out[i] = static_cast<uint8_t>( entry.key >> ( 56 - 8 * i ) );
+        out[8] = static_cast<uint8_t>( entry.move >> 8 );
+        out[9] = static_cast<uint8_t>( entry.move );
+        out[10] = static_cast<uint8_t>( entry.weight >> 8 );
+        out[11] = static_cast<uint8_t>( entry.weight );
+        for ( int i = 0; i < 4; i++ )
+            out[12 + i] = static_cast<uint8_t>( entry.learn >> ( 24 - 8 * i ) );
+    }
+
+  private:
+    const uint8_t *data = nullptr;
+    size_t bytes = 0;
+
+    Entry ReadEntry( size_t index ) const {
+        const uint8_t *in = data + index * ENTRY_BYTES;
+        Entry entry{};
+        for ( int i = 0; i < 8; i++ )
+            entry.key = entry.key << 8 | in[i];
+        entry.move = static_cast<uint16_t>( in[8] << 8 | in[9] );
+        entry.weight = static_cast<uint16_t>( in[10] << 8 | in[11] );
+        for ( int i = 0; i < 4; i++ )
+            entry.learn = entry.learn << 8 | in[12 + i];
+        return entry;
+    }
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+// ============================================================================
+// Specialized Endgame Evaluators
+// ============================================================================
+// Used instead of the general evaluation when the material signature says
+// the general terms cannot find the win (see material.h). Each returns a
+// white-relative score; strongWhite tells which side has the mating force.
+
+#include "board.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace Endgame {
+
+using EvaluatorFunc = int ( * )( const Board &board, bool strongWhite );
+
+// Above any ordinary evaluation, below Evaluator::CHECKMATE
+constexpr int KNOWN_WIN = 5000;
+
+inline int Distance( int a, int b ) {
+    return std::max( abs( FileOf( a ) - FileOf( b ) ), abs( RankOf( a ) - RankOf( b ) ) );
+}
+
+// 0 on the edge, 3 in the center
+inline int EdgeDistance( int square ) {
+    return std::min( std::min( FileOf( square ), 7 - FileOf( square ) ),
+                     std::min( RankOf( square ), 7 - RankOf( square ) ) );
+}
+
+inline int NonPawnMaterial( const Board &board, bool white ) {
+    int base = white ? 0 : 6;
+    int total = 0;
+    for ( int type = 1; type < 5; type++ ) {
+        total += board.pieceCount[base + type] * PSQT::PIECE_VALUES[type];
+    }
+    return total;
+}
+
+// ============================================================================
+// KXK: mating material against a bare king
+// ============================================================================
+// Drive the weak king to the edge and bring the strong king closer.
+
+inline int KXK( const Board &board, bool strongWhite ) {
+    int strongKing = BitScanForward( board.bitboards[strongWhite ? WK : BK] );
+    int weakKing = BitScanForward( board.bitboards[strongWhite ? BK : WK] );
+
+    int score = KNOWN_WIN + NonPawnMaterial( board, strongWhite ) +
+                board.pieceCount[strongWhite ? WP : BP] * PSQT::PIECE_VALUES[0];
+    score += 40 * ( 3 - EdgeDistance( weakKing ) );
+    score += 10 * ( 7 - Distance( strongKing, weakKing ) );
+
+    return strongWhite ? score : -score;
+}
+
+// ============================================================================
+// KBNK: bishop and knight against a bare king
+// ============================================================================
+// Mate is only possible in a corner of the bishop's color, so drive the weak
+// king toward one of those two corners.
+
+inline int KBNK( const Board &board, bool strongWhite ) {
+    int strongKing = BitScanForward( board.bitboards[strongWhite ? WK : BK] );
+    int weakKing = BitScanForward( board.bitboards[strongWhite ? BK : WK] );
+    int bishop = BitScanForward( board.bitboards[strongWhite ? WB : BB] );
+
+    // a1 and h8 are dark squares, (rank + file) even
+    bool darkBishop = ( ( RankOf( bishop ) + FileOf( bishop ) ) & 1 ) == 0;
+    int cornerDistance = darkBishop ? std::min( Distance( weakKing, A1 ), Distance( weakKing, H8 ) )
+                                    : std::min( Distance( weakKing, A8 ), Distance( weakKing, H1 ) );
+
+    int score = KNOWN_WIN + NonPawnMaterial( board, strongWhite );
+    score += 40 * ( 7 - cornerDistance );
+    score += 10 * ( 7 - Distance( strongKing, weakKing ) );
+
+    return strongWhite ? score : -score;
+}
+
+// ============================================================================
+// KPK: king and pawn against a bare king, known won
+// ============================================================================
+// Only used once the bitbase has the position as a win: push the pawn and
+// keep the strong king close to it, so the search makes progress toward a
+// promotion.
+
+inline int KPK( const Board &board, bool strongWhite ) {
+    int strongKing = BitScanForward( board.bitboards[strongWhite ? WK : BK] );
+    int pawn = BitScanForward( board.bitboards[strongWhite ? WP : BP] );
+    int rank = strongWhite ? RankOf( pawn ) : 7 - RankOf( pawn );
+
+    int score = KNOWN_WIN + PSQT::PIECE_VALUES[0] + 20 * rank;
+    score += 10 * ( 7 - Distance( strongKing, pawn ) );
+
+    return strongWhite ? score : -score;
+}
+
+} // namespace Endgame
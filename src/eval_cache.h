@@ -0,0 +1,58 @@
+#pragma once
+
+// ============================================================================
+// Evaluation Cache
+// ============================================================================
+// Direct-mapped cache of static evaluations keyed by Board::hashKey. Leaf
+// positions recur across iterations, transpositions and quiescence, and the
+// static eval of a position never changes, so entries stay valid for the
+// lifetime of the table. The low key bits pick the slot and the high 32
+// bits verify it, keeping each entry at 8 bytes.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+class EvalCache {
+  public:
+    static constexpr size_t DEFAULT_ENTRIES = 1 << 16; // Must be a power of two
+
+    explicit EvalCache( size_t entries = DEFAULT_ENTRIES ) : table( entries ), mask( entries - 1 ) {}
+
+    // Returns true and sets eval if the position is cached
+    bool Probe( uint64_t key, int &eval ) {
+        probes++;
+        const Entry &entry = table[key & mask];
+        if ( entry.check != Check( key ) || entry.eval == EMPTY )
+            return false;
+        hits++;
+        eval = entry.eval;
+        return true;
+    }
+
+    void Store( uint64_t key, int eval ) { table[key & mask] = { Check( key ), eval }; }
+
+    void Clear() {
+        std::fill( table.begin(), table.end(), Entry() );
+        probes = hits = 0;
+    }
+
+    double HitRate() const { return probes ? static_cast<double>( hits ) / probes : 0.0; }
+
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+  private:
+    static constexpr int32_t EMPTY = INT32_MIN; // Never a real evaluation
+
+    struct Entry {
+        uint32_t check = 0;
+        int32_t eval = EMPTY;
+    };
+
+    static uint32_t Check( uint64_t key ) { return static_cast<uint32_t>( key >> 32 ); }
+
+    std::vector<Entry> table;
+    size_t mask;
+};
@@ -0,0 +1,222 @@
+#pragma once
+
+// ============================================================================
+// Set-wise Fills
+// ============================================================================
+// Operations on whole bitboards instead of one square at a time: one-step
+// shifts, pawn spans, file fills, and Kogge-Stone occluded fills that give
+// the attacks of every slider in a set at once. Everything is branch-free.
+//
+// Kogge-Stone: to fill from the generators `gen` through the `empty`
+// squares in one direction, propagate by 1, 2 and 4 steps, shrinking the
+// propagator set each time. Three rounds cover the 7 possible steps.
+//
+// With AVX2 the four directions of a rook or a bishop run in the four lanes
+// of one register, using per-lane variable shifts.
+
+#include "bitboard.h"
+#include <cstdint>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+
+namespace Fills {
+
+// ============================================================================
+// One-step Shifts
+// ============================================================================
+
+inline constexpr uint64_t North( uint64_t b ) { return b << 8; }
+inline constexpr uint64_t South( uint64_t b ) { return b >> 8; }
+inline constexpr uint64_t East( uint64_t b ) { return ( b & NOT_FILE_H ) << 1; }
+inline constexpr uint64_t West( uint64_t b ) { return ( b & NOT_FILE_A ) >> 1; }
+
+// Positive shifts move toward h8, negative toward a1
+inline constexpr uint64_t ShiftBy( uint64_t b, int shift ) { return shift > 0 ? b << shift : b >> -shift; }
+
+// ============================================================================
+// Fills and Spans
+// ============================================================================
+
+inline constexpr uint64_t NorthFill( uint64_t b ) {
+    b |= b << 8;
+    b |= b << 16;
+    b |= b << 32;
+    return b;
+}
+
+inline constexpr uint64_t SouthFill( uint64_t b ) {
+    b |= b >> 8;
+    b |= b >> 16;
+    b |= b >> 32;
+    return b;
+}
+
+// Whole files containing any bit of b
+inline constexpr uint64_t FileFill( uint64_t b ) { return NorthFill( SouthFill( b ) ); }
+
+// Occupied files as an 8-bit set, bit n = file n
+inline constexpr uint8_t FileSet( uint64_t b ) { return static_cast<uint8_t>( SouthFill( b ) & RANK_1 ); }
+
+inline constexpr uint64_t WithAdjacentFiles( uint64_t b ) { return b | East( b ) | West( b ); }
+
+// Files with pawns but none on either neighbouring file, for 8-bit file sets
+inline constexpr uint8_t IsolatedFiles( uint8_t files ) {
+    return static_cast<uint8_t>( files & ~( ( files << 1 ) | ( files >> 1 ) ) );
+}
+
+// Squares strictly in front of / behind each pawn, from its own side's view
+inline constexpr uint64_t FrontSpan( uint64_t pawns, bool white ) {
+    return white ? NorthFill( North( pawns ) ) : SouthFill( South( pawns ) );
+}
+
+inline constexpr uint64_t RearSpan( uint64_t pawns, bool white ) {
+    return white ? SouthFill( South( pawns ) ) : NorthFill( North( pawns ) );
+}
+
+// Squares the pawns attack now or after any number of pushes
+inline constexpr uint64_t AttackSpan( uint64_t pawns, bool white ) {
+    uint64_t attacks = white ? North( East( pawns ) | West( pawns ) ) : South( East( pawns ) | West( pawns ) );
+    return white ? NorthFill( attacks ) : SouthFill( attacks );
+}
+
+// Pawns with no enemy pawn ahead of them on their own or an adjacent file
+inline constexpr uint64_t PassedPawns( uint64_t ourPawns, uint64_t enemyPawns, bool white ) {
+    return ourPawns & ~WithAdjacentFiles( FrontSpan( enemyPawns, !white ) );
+}
+
+// ============================================================================
+// Leaper Attacks
+// ============================================================================
+
+inline constexpr uint64_t PawnAttacks( uint64_t pawns, bool white ) {
+    return white ? North( East( pawns ) | West( pawns ) ) : South( East( pawns ) | West( pawns ) );
+}
+
+inline constexpr uint64_t KnightAttacks( uint64_t knights ) {
+    uint64_t east1 = East( knights ), west1 = West( knights );
+    uint64_t east2 = East( east1 ), west2 = West( west1 );
+    uint64_t one = east1 | west1, two = east2 | west2;
+    return ( one << 16 ) | ( one >> 16 ) | ( two << 8 ) | ( two >> 8 );
+}
+
+inline constexpr uint64_t KingAttacks( uint64_t kings ) {
+    uint64_t row = kings | East( kings ) | West( kings );
+    return ( row | North( row ) | South( row ) ) & ~kings;
+}
+
+// ============================================================================
+// Kogge-Stone Occluded Fills
+// ============================================================================
+
+struct Directions {
+    int shift[4];
+    uint64_t mask[4]; // Squares a step can land on without wrapping around
+};
+
+inline constexpr Directions ROOK_DIRECTIONS = { { 8, -8, 1, -1 }, { ~0ULL, ~0ULL, NOT_FILE_A, NOT_FILE_H } };
+inline constexpr Directions BISHOP_DIRECTIONS = { { 9, 7, -7, -9 },
+                                                  { NOT_FILE_A, NOT_FILE_H, NOT_FILE_A, NOT_FILE_H } };
+
+// gen plus every square reachable from it through empty squares
+inline constexpr uint64_t OccludedFill( uint64_t gen, uint64_t empty, int shift, uint64_t mask ) {
+    empty &= mask;
+    gen |= empty & ShiftBy( gen, shift );
+    empty &= ShiftBy( empty, shift );
+    gen |= empty & ShiftBy( gen, 2 * shift );
+    empty &= ShiftBy( empty, 2 * shift );
+    gen |= empty & ShiftBy( gen, 4 * shift );
+    return gen;
+}
+
+// Attacks in one direction: the occluded fill moved one step, which adds the
+// first blocker
+inline constexpr uint64_t SlidingAttacks( uint64_t sliders, uint64_t empty, int shift, uint64_t mask ) {
+    return ShiftBy( OccludedFill( sliders, empty, shift, mask ), shift ) & mask;
+}
+
+inline constexpr uint64_t SlidingAttacksScalar( uint64_t sliders, uint64_t empty, const Directions &directions ) {
+    uint64_t attacks = 0;
+    for ( int d = 0; d < 4; d++ ) {
+        attacks |= SlidingAttacks( sliders, empty, directions.shift[d], directions.mask[d] );
+    }
+    return attacks;
+}
+
+#if defined( __AVX2__ )
+
+// Four directions at once, one per 64-bit lane. Unused shift counts are 64,
+// which variable shifts turn into zero.
+inline uint64_t SlidingAttacksAvx2( uint64_t sliders, uint64_t empty, const Directions &directions ) {
+    alignas( 32 ) long long left[4], right[4], mask[4];
+    for ( int d = 0; d < 4; d++ ) {
+        left[d] = directions.shift[d] > 0 ? directions.shift[d] : 64;
+        right[d] = directions.shift[d] < 0 ? -directions.shift[d] : 64;
+        mask[d] = static_cast<long long>( directions.mask[d] );
+    }
+    __m256i left1 = _mm256_load_si256( reinterpret_cast<const __m256i *>( left ) );
+    __m256i right1 = _mm256_load_si256( reinterpret_cast<const __m256i *>( right ) );
+    __m256i left2 = _mm256_add_epi64( left1, left1 ), right2 = _mm256_add_epi64( right1, right1 );
+    __m256i left4 = _mm256_add_epi64( left2, left2 ), right4 = _mm256_add_epi64( right2, right2 );
+    __m256i masks = _mm256_load_si256( reinterpret_cast<const __m256i *>( mask ) );
+
+    auto shift = []( __m256i b, __m256i l, __m256i r ) {
+        return _mm256_or_si256( _mm256_sllv_epi64( b, l ), _mm256_srlv_epi64( b, r ) );
+    };
+
+    __m256i gen = _mm256_set1_epi64x( static_cast<long long>( sliders ) );
+    __m256i pro = _mm256_and_si256( _mm256_set1_epi64x( static_cast<long long>( empty ) ), masks );
+    gen = _mm256_or_si256( gen, _mm256_and_si256( pro, shift( gen, left1, right1 ) ) );
+    pro = _mm256_and_si256( pro, shift( pro, left1, right1 ) );
+    gen = _mm256_or_si256( gen, _mm256_and_si256( pro, shift( gen, left2, right2 ) ) );
+    pro = _mm256_and_si256( pro, shift( pro, left2, right2 ) );
+    gen = _mm256_or_si256( gen, _mm256_and_si256( pro, shift( gen, left4, right4 ) ) );
+    __m256i attacks = _mm256_and_si256( shift( gen, left1, right1 ), masks );
+
+    __m128i half = _mm_or_si128( _mm256_castsi256_si128( attacks ), _mm256_extracti128_si256( attacks, 1 ) );
+    return static_cast<uint64_t>( _mm_cvtsi128_si64( _mm_or_si128( half, _mm_unpackhi_epi64( half, half ) ) ) );
+}
+
+#endif
+
+// Attacks of every slider in the set, blocked by the non-empty squares
+inline uint64_t SlidingAttacks( uint64_t sliders, uint64_t empty, const Directions &directions ) {
+#if defined( __AVX2__ )
+    return SlidingAttacksAvx2( sliders, empty, directions );
+#else
+    return SlidingAttacksScalar( sliders, empty, directions );
+#endif
+}
+
+inline uint64_t RookAttacks( uint64_t rooks, uint64_t empty ) {
+    return SlidingAttacks( rooks, empty, ROOK_DIRECTIONS );
+}
+
+inline uint64_t BishopAttacks( uint64_t bishops, uint64_t empty ) {
+    return SlidingAttacks( bishops, empty, BISHOP_DIRECTIONS );
+}
+
+inline uint64_t QueenAttacks( uint64_t queens, uint64_t empty ) {
+    return RookAttacks( queens, empty ) | BishopAttacks( queens, empty );
+}
+
+// ============================================================================
+// Compile-time Checks
+// ============================================================================
+
+static_assert( FrontSpan( 1ULL << E2, true ) == ( FILE_E & ~( RANK_1 | RANK_2 ) ) );
+static_assert( FrontSpan( 1ULL << E7, false ) == ( FILE_E & ~( RANK_7 | RANK_8 ) ) );
+static_assert( RearSpan( 1ULL << E7, false ) == 1ULL << E8 );
+static_assert( FileSet( ( 1ULL << A2 ) | ( 1ULL << H7 ) ) == 0x81 );
+static_assert( IsolatedFiles( 0b10110001 ) == 0b10000001 );
+static_assert( KnightAttacks( 1ULL << A1 ) == ( ( 1ULL << B3 ) | ( 1ULL << C2 ) ) );
+static_assert( KingAttacks( 1ULL << H8 ) == ( ( 1ULL << G8 ) | ( 1ULL << G7 ) | ( 1ULL << H7 ) ) );
+static_assert( PassedPawns( 1ULL << E5, 1ULL << D7, true ) == 0 );
+static_assert( PassedPawns( 1ULL << E5, 1ULL << C7, true ) == 1ULL << E5 );
+static_assert( SlidingAttacksScalar( 1ULL << A1, ~0ULL, ROOK_DIRECTIONS ) == ( ( FILE_A | RANK_1 ) & ~1ULL ) );
+static_assert( SlidingAttacksScalar( 1ULL << D4, ~( 1ULL << F6 ), BISHOP_DIRECTIONS ) ==
+               ( ( 1ULL << C5 ) | ( 1ULL << B6 ) | ( 1ULL << A7 ) | ( 1ULL << E5 ) | ( 1ULL << F6 ) | ( 1ULL << C3 ) |
+                 ( 1ULL << B2 ) | ( 1ULL << A1 ) | ( 1ULL << E3 ) | ( 1ULL << F2 ) | ( 1ULL << G1 ) ) );
+
+} // namespace Fills
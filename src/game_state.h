@@ -7,6 +7,7 @@
 // NOTE: This file must be included AFTER board.h defines the Board class.
 
 #include "move_generator.h"
+#include <cassert>
 #include <vector>
 
 // Forward declaration
@@ -26,45 +27,60 @@ inline bool IsSquareAttacked( const Board &board, int square, bool byWhite ) {
 // King In Check
 // ============================================================================
 
-inline bool IsKingInCheck( const Board &board, bool white ) {
-    int kingIndex = white ? WK : BK;
-    uint64_t kingBitboard = board.bitboards[kingIndex];
+template <bool White> inline bool IsKingInCheck( const Board &board ) {
+    uint64_t kingBitboard = board.bitboards[ColorTraits<White>::KING];
 
     if ( kingBitboard == 0 )
         return false;
 
     int kingSquare = BitScanForward( kingBitboard );
-    return IsSquareAttacked( board, kingSquare, !white );
+    return MoveGen::IsSquareAttacked<!White>( board, kingSquare );
+}
+
+inline bool IsKingInCheck( const Board &board, bool white ) {
+    return white ? IsKingInCheck<true>( board ) : IsKingInCheck<false>( board );
 }
 
 // ============================================================================
 // Move Legality
 // ============================================================================
 
-inline bool IsMoveLegal( Board &board, Move &move, bool white ) {
-    board.MakeMove( move );
-    bool kingInCheck = IsKingInCheck( board, white );
-    board.UndoMove( move );
+template <bool White> inline bool IsMoveLegal( Board &board, Move &move ) {
+    board.MakeMove<White>( move );
+    bool kingInCheck = IsKingInCheck<White>( board );
+    board.UndoMove<White>( move );
     return !kingInCheck;
 }
 
+// white must be the side to move: the move is made and undone
+inline bool IsMoveLegal( Board &board, Move &move, bool white ) {
+    assert( white == board.whiteToMove );
+    return white ? IsMoveLegal<true>( board, move ) : IsMoveLegal<false>( board, move );
+}
+
 // ============================================================================
 // Generate All Legal Moves
 // ============================================================================
 
-inline void GenerateAllLegalMoves( Board &board, std::vector<Move> &moves, bool white ) {
+template <bool White> inline void GenerateAllLegalMoves( Board &board, std::vector<Move> &moves ) {
     moves.clear();
 
     std::vector<Move> pseudoLegal;
-    MoveGen::GenerateAllPseudoLegal( board, pseudoLegal, white );
+    MoveGen::GenerateAllPseudoLegal<White>( board, pseudoLegal );
 
     for ( Move &move : pseudoLegal ) {
-        if ( IsMoveLegal( board, move, white ) ) {
+        if ( IsMoveLegal<White>( board, move ) ) {
             moves.push_back( move );
         }
     }
 }
 
+// white must be the side to move, as for IsMoveLegal
+inline void GenerateAllLegalMoves( Board &board, std::vector<Move> &moves, bool white ) {
+    assert( white == board.whiteToMove );
+    white ? GenerateAllLegalMoves<true>( board, moves ) : GenerateAllLegalMoves<false>( board, moves );
+}
+
 // ============================================================================
 // Checkmate Detection
 // ============================================================================
@@ -1,12 +1,19 @@
 #pragma once
 
+#include "bitbase.h"
 #include "board.h"
+#include "book.h"
 #include "evaluate.h"
+#include "profiler.h"
 #include "raylib.h"
 #include "search.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <ostream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 class ChessGUI {
   public:
@@ -18,29 +25,71 @@ class ChessGUI {
         squareSize = ( screenHeight - 2 * padding ) / boardSize;
         LoadPieceTextures();
         SetTargetFPS( 60 );
+        if ( book.Open( BOOK_PATH ) ) {
+            engine.book = &book;
+            std::cout << "Opening book " << BOOK_PATH << ": " << book.Size() << " entries" << std::endl;
+        }
+        Bitbases::Init(); // Built before the engine's first move, not during it
+
+        boardLayer = LoadRenderTexture( screenWidth, screenHeight );
+        sceneLayer = LoadRenderTexture( screenWidth, screenHeight );
+        BeginTextureMode( boardLayer );
+        ClearBackground( RAYWHITE );
+        DrawBoard();
+        DrawCoordinates();
+        EndTextureMode();
+
+        OnPositionChanged();
     }
 
     ~ChessGUI() {
+        CancelAISearch();
+        UnloadRenderTexture( boardLayer );
+        UnloadRenderTexture( sceneLayer );
         for ( auto &[_, tex] : pieceTextures ) {
             UnloadTexture( tex );
         }
         CloseWindow();
     }
 
+    // Frames are event driven: with nothing to poll, EndDrawing sleeps until
+    // the next input event, and each frame only blits the composed scene.
+    // The scene is recomposed when the position, selection or status changes.
     void Run() {
         while ( !WindowShouldClose() ) {
-            BeginDrawing();
-            ClearBackground( RAYWHITE );
-
-            DrawBoard();
-            DrawCoordinates();
-            DrawPieces();
-            DrawGameStatus();
-            HandleAI();
-            HandleMouseInput();
-            HandleKeyboardInput();
-
-            EndDrawing();
+            double phaseSeconds[PHASE_COUNT] = {};
+            {
+                PROFILE_SCOPE( phaseSeconds[PHASE_AI] );
+                HandleAI();
+            }
+            {
+                PROFILE_SCOPE( phaseSeconds[PHASE_INPUT] );
+                HandleMouseInput();
+                HandleKeyboardInput();
+            }
+            {
+                PROFILE_SCOPE( phaseSeconds[PHASE_COMPOSE] );
+                if ( sceneDirty ) {
+                    ComposeScene();
+                }
+            }
+            UpdateEventWaiting();
+
+            {
+                PROFILE_SCOPE( phaseSeconds[PHASE_DRAW] );
+                BeginDrawing();
+                ClearBackground( RAYWHITE );
+                DrawLayer( sceneLayer );
+                if ( hudVisible ) {
+                    DrawHud();
+                }
+            }
+            {
+                // Buffer swap plus the frame limiter's or event wait's sleep
+                PROFILE_SCOPE( phaseSeconds[PHASE_PRESENT] );
+                EndDrawing();
+            }
+            RecordFrame( phaseSeconds );
         }
     }
 
@@ -51,16 +100,34 @@ class ChessGUI {
     int padding;
     std::unordered_map<int, Texture2D> pieceTextures;
 
+    // Squares and coordinates never change; the scene adds highlights,
+    // pieces and the status line on top
+    RenderTexture2D boardLayer;
+    RenderTexture2D sceneLayer;
+    bool sceneDirty = true;
+    bool waitingForEvents = false;
+
+    // Performance overlay, toggled with F3. Timings come from PROFILE_SCOPE
+    // and read zero when profiling is compiled out.
+    enum RunPhase { PHASE_AI, PHASE_INPUT, PHASE_COMPOSE, PHASE_DRAW, PHASE_PRESENT, PHASE_COUNT };
+    static constexpr const char *PHASE_NAMES[PHASE_COUNT] = { "AI poll", "Input", "Compose", "Draw", "Present" };
+    static constexpr int HUD_SAMPLES = 240; // Four seconds at 60 FPS
+    bool hudVisible = false;
+    Profiler::History<HUD_SAMPLES> frameMs;
+    Profiler::History<HUD_SAMPLES> phaseMs[PHASE_COUNT];
+    SearchEngine::SearchResult lastSearch; // Of the last move the AI played
+
     Board *board;
 
     int selectedSquare = -1; // -1 means no selection
     int clickedSquare = -1;
-    std::vector<Move> legalMoves;
+    std::vector<Move> legalMoves; // Of the selected piece
     std::vector<Move> moveHistory;
 
-    // Game state
+    // Game state, cached per position by OnPositionChanged
     enum GuiGameState { PLAYING, CHECKMATE_WHITE_WINS, CHECKMATE_BLACK_WINS, STALEMATE, CHECK };
     GuiGameState guiGameState = PLAYING;
+    std::vector<Move> positionMoves; // Every legal move in the current position
 
     // AI config
     bool aiEnabled = true;
@@ -68,6 +135,31 @@ class ChessGUI {
     int aiDepth = 5;
     SearchEngine engine;
 
+    // Opening book from tools/make_book.cpp, used when present in the working directory
+    static constexpr const char *BOOK_PATH = "book.bin";
+    OpeningBook book;
+
+    // Background search. The worker owns aiBoard and aiResult until it sets
+    // aiDone; the render loop polls the flag once per frame.
+    using Clock = std::chrono::steady_clock;
+    std::thread aiThread;
+    std::atomic<bool> aiDone{ false };
+    bool aiThinking = false;
+    Board aiBoard;
+    SearchEngine::SearchResult aiResult;
+    Clock::time_point aiStarted, aiFinished;
+
+    // Pondering: after the AI moves, search the position after the reply
+    // its PV predicts. On a hit that search simply becomes the AI's move
+    // search; on a miss it is cancelled and a fresh one starts.
+    bool ponderEnabled = true;
+    bool pondering = false;
+    Move ponderMove = Move( 0, 0 );
+    int ponderHits = 0;
+    int ponderMisses = 0;
+    double ponderSavedSeconds = 0; // Search time already done when the human moved
+    Clock::time_point humanMoved;
+
     void LoadPieceTextures() {
         std::string names[12] = { "wP", "wN", "wB", "wR", "wQ", "wK", "bP", "bN", "bB", "bR", "bQ", "bK" };
 
@@ -77,12 +169,20 @@ class ChessGUI {
         }
     }
 
+    // Call after every move, undo or reset: the one place legal moves are generated for the GUI
+    void OnPositionChanged() {
+        ::GameState::GenerateAllLegalMoves( *board, positionMoves, board->whiteToMove );
+        guiGameState = CheckGuiGameState();
+        selectedSquare = -1;
+        clickedSquare = -1;
+        legalMoves.clear();
+        sceneDirty = true;
+    }
+
     GuiGameState CheckGuiGameState() {
-        std::vector<Move> moves;
-        ::GameState::GenerateAllLegalMoves( *board, moves, board->whiteToMove );
         bool inCheck = ::GameState::IsKingInCheck( *board, board->whiteToMove );
 
-        if ( moves.empty() ) {
+        if ( positionMoves.empty() ) {
             if ( inCheck ) {
                 // Checkmate
                 return board->whiteToMove ? CHECKMATE_BLACK_WINS : CHECKMATE_WHITE_WINS;
@@ -121,6 +221,96 @@ class ChessGUI {
         return MoveGen::IsSquareAttacked( *board, kingSquare, !board->whiteToMove );
     }
 
+    // Render textures are stored upside down, so draw them with a negative height
+    void DrawLayer( const RenderTexture2D &layer ) {
+        DrawTextureRec( layer.texture, { 0, 0, (float)layer.texture.width, -(float)layer.texture.height }, { 0, 0 },
+                        WHITE );
+    }
+
+    void ComposeScene() {
+        BeginTextureMode( sceneLayer );
+        ClearBackground( RAYWHITE );
+        DrawLayer( boardLayer );
+        DrawHighlights();
+        DrawPieces();
+        DrawGameStatus();
+        EndTextureMode();
+        sceneDirty = false;
+    }
+
+    // Poll every frame only while the AI searches on its own time, so the
+    // result is picked up without waiting for input, while a search is due
+    // to start (the AI is to move after the human's move, U or R), or while
+    // the HUD is up
+    void UpdateEventWaiting() {
+        bool searchDue = !aiThinking && AIToMove();
+        bool wait = ( !aiThinking || pondering ) && !searchDue && !hudVisible;
+        if ( wait == waitingForEvents )
+            return;
+        waitingForEvents = wait;
+        if ( wait )
+            EnableEventWaiting();
+        else
+            DisableEventWaiting();
+    }
+
+    void RecordFrame( const double ( &phaseSeconds )[PHASE_COUNT] ) {
+        frameMs.Push( GetFrameTime() * 1000.0f );
+        for ( int phase = 0; phase < PHASE_COUNT; phase++ ) {
+            phaseMs[phase].Push( static_cast<float>( phaseSeconds[phase] * 1000.0 ) );
+        }
+    }
+
+    void DrawHud() {
+        const int x = 10, width = 300, lineHeight = 14, fontSize = 12;
+        const int graphHeight = 50;
+        int y = 40;
+        DrawRectangle( x - 5, y - 5, width + 10, 12 * lineHeight + graphHeight + 15, Fade( BLACK, 0.75f ) );
+
+        DrawText( TextFormat( "Frame ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f", frameMs.Percentile( 0.5f ),
+                              frameMs.Percentile( 0.95f ), frameMs.Percentile( 0.99f ), frameMs.Max() ),
+                  x, y, fontSize, WHITE );
+        y += lineHeight;
+#if defined( CHESS_NO_PROFILE )
+        DrawText( "Phase timers compiled out (CHESS_NO_PROFILE)", x, y, fontSize, GRAY );
+        y += lineHeight;
+#else
+        for ( int phase = 0; phase < PHASE_COUNT; phase++ ) {
+            DrawText( TextFormat( "  %-8s mean %.3f  max %.3f ms", PHASE_NAMES[phase], phaseMs[phase].Mean(),
+                                  phaseMs[phase].Max() ),
+                      x, y, fontSize, LIGHTGRAY );
+            y += lineHeight;
+        }
+#endif
+
+        const SearchEngine::SearchProfile &profile = lastSearch.profile;
+        double seconds = profile.totalSeconds;
+        DrawText( TextFormat( "Search  depth %d  nodes %llu", lastSearch.depth,
+                              static_cast<unsigned long long>( lastSearch.nodesSearched ) ),
+                  x, y, fontSize, WHITE );
+        y += lineHeight;
+        double nps = seconds > 0 ? lastSearch.nodesSearched / seconds : 0;
+        DrawText( TextFormat( "  %.3f s/move  %.0f nps", seconds, nps ), x, y, fontSize, LIGHTGRAY );
+        y += lineHeight;
+        DrawText( TextFormat( "  movegen %.0f%%  eval %.0f%%", seconds > 0 ? 100 * profile.moveGenSeconds / seconds : 0,
+                              seconds > 0 ? 100 * profile.evalSeconds / seconds : 0 ),
+                  x, y, fontSize, LIGHTGRAY );
+        y += lineHeight;
+        DrawText( aiThinking ? ( pondering ? "  pondering..." : "  thinking..." ) : "  idle", x, y, fontSize,
+                  aiThinking ? GOLD : GRAY );
+        y += lineHeight + 4;
+
+        // Rolling frame-time graph, scaled so a 60 FPS frame sits at mid-height
+        float scale = graphHeight / std::max( 2 * 1000.0f / 60, frameMs.Max() );
+        int budget = y + graphHeight - static_cast<int>( 1000.0f / 60 * scale );
+        DrawLine( x, budget, x + width, budget, DARKGREEN );
+        for ( int i = 0; i < frameMs.Size(); i++ ) {
+            int barX = x + i * width / HUD_SAMPLES;
+            int barHeight = static_cast<int>( frameMs.At( i ) * scale );
+            DrawLine( barX, y + graphHeight, barX, y + graphHeight - barHeight, frameMs.At( i ) > 20 ? RED : SKYBLUE );
+        }
+    }
+
     void DrawBoard() {
         Color lightColor = { 240, 217, 181, 255 };
         Color darkColor = { 181, 136, 99, 255 };
@@ -131,7 +321,9 @@ class ChessGUI {
                 DrawRectangle( padding + col * squareSize, padding + row * squareSize, squareSize, squareSize, color );
             }
         }
+    }
 
+    void DrawHighlights() {
         // Highlight the selected square
         if ( selectedSquare != -1 ) {
             int selRow = 7 - ( selectedSquare / 8 );
@@ -202,24 +394,20 @@ class ChessGUI {
     }
 
     void DrawPieces() {
-        for ( int i = 0; i < 12; ++i ) {
-            uint64_t bb = board->bitboards[i];
-            for ( int sq = 0; sq < 64; ++sq ) {
-                if ( bb & ( 1ULL << sq ) ) {
-                    int row = 7 - ( sq / 8 );
-                    int col = sq % 8;
-                    int x = padding + col * squareSize;
-                    int y = padding + row * squareSize;
-                    DrawTextureEx( pieceTextures[i], { (float)x, (float)y }, 0.0f,
-                                   (float)squareSize / pieceTextures[i].width, WHITE );
-                }
-            }
+        for ( int sq = 0; sq < 64; ++sq ) {
+            int piece = board->mailbox[sq];
+            if ( piece == NO_PIECE )
+                continue;
+            int row = 7 - ( sq / 8 );
+            int col = sq % 8;
+            int x = padding + col * squareSize;
+            int y = padding + row * squareSize;
+            DrawTextureEx( pieceTextures[piece], { (float)x, (float)y }, 0.0f,
+                           (float)squareSize / pieceTextures[piece].width, WHITE );
         }
     }
 
     void DrawGameStatus() {
-        guiGameState = CheckGuiGameState();
-
         std::string statusText;
         Color statusColor = BLACK;
 
@@ -245,6 +433,9 @@ class ChessGUI {
             statusColor = DARKGRAY;
             break;
         }
+        if ( aiThinking && !pondering && guiGameState != CHECK ) {
+            statusText = std::string( board->whiteToMove ? "White" : "Black" ) + " (AI) is thinking...";
+        }
 
         // Draw status text
         int textWidth = MeasureText( statusText.c_str(), 24 );
@@ -274,71 +465,172 @@ class ChessGUI {
         }
     }
 
+    // The AI is on and to move, and the game is not over
+    bool AIToMove() const {
+        bool gameOver = guiGameState == CHECKMATE_WHITE_WINS || guiGameState == CHECKMATE_BLACK_WINS ||
+                        guiGameState == STALEMATE;
+        return aiEnabled && board->whiteToMove == aiPlaysAsWhite && !gameOver;
+    }
+
     void HandleAI() {
-        // Don't let AI play if game is over
-        if ( guiGameState == CHECKMATE_WHITE_WINS || guiGameState == CHECKMATE_BLACK_WINS ||
-             guiGameState == STALEMATE ) {
+        if ( aiThinking ) {
+            if ( !pondering )
+                PollAISearch();
             return;
         }
 
-        // Check if it's AI's turn
-        bool isAITurn = aiEnabled && ( board->whiteToMove == aiPlaysAsWhite );
-        if ( isAITurn ) {
-            // Generate moves to check if game is over
-            std::vector<Move> moves;
-            GameState::GenerateAllLegalMoves( *board, moves, board->whiteToMove );
-
-            if ( moves.empty() ) {
-                std::cout << "Game Over - No legal moves!" << std::endl;
-                return;
-            }
-
+        if ( AIToMove() ) {
             std::cout << "=== AI Debug Info ===" << std::endl;
-            std::cout << "Generated " << moves.size() << " moves" << std::endl;
             std::cout << "Current turn: " << ( board->whiteToMove ? "White" : "Black" ) << std::endl;
             std::cout << "AI plays as: " << ( aiPlaysAsWhite ? "White" : "Black" ) << std::endl;
 
-            std::cout << "AI thinking using SearchEngine..." << std::endl;
-
             // Debug: Show current position evaluation
-            int currentEval = Evaluator::Evaluate( *board );
+            int currentEval = Evaluator::Evaluate( *board, true );
             std::cout << "Current position eval: " << currentEval << std::endl;
 
-            // Call FindBestMove from the SearchEngine
-            // This will perform the alpha-beta search with iterative deepening
-            SearchEngine::SearchResult result = engine.FindBestMove( *board, aiDepth );
+            std::cout << "AI thinking using SearchEngine..." << std::endl;
+            StartAISearch();
+        }
+    }
+
+    // Search a private copy of a position on a worker thread
+    void StartAISearch( const Board &position ) {
+        aiBoard = position;
+        aiDone.store( false );
+        engine.stop.store( false );
+        aiThinking = true;
+        sceneDirty = true;
+        aiStarted = Clock::now();
+        aiThread = std::thread( [this] {
+            aiResult = engine.FindBestMove( aiBoard, aiDepth );
+            aiFinished = Clock::now();
+            aiDone.store( true, std::memory_order_release );
+        } );
+    }
 
-            Move selectedMove = result.bestMove;
-            int bestScore = result.score;
+    void StartAISearch() { StartAISearch( *board ); }
+
+    // Abort the search in progress, if any, and drop its result
+    void CancelAISearch() {
+        if ( !aiThinking )
+            return;
+        engine.stop.store( true );
+        aiThread.join();
+        aiThinking = false;
+        sceneDirty = true;
+        std::cout << ( pondering ? "Ponder search cancelled" : "AI search cancelled" ) << std::endl;
+        pondering = false;
+    }
 
-            if ( selectedMove.fromSquare == 0 && selectedMove.toSquare == 0 && moves.size() > 0 ) {
-                selectedMove = moves[0];
-                std::cout << "SearchEngine returned a default move, falling "
-                             "back to first legal move."
-                          << std::endl;
+    // After the AI's move, search the position after the predicted reply
+    void StartPondering( const std::vector<Move> &pv ) {
+        if ( !ponderEnabled || pv.size() < 2 )
+            return;
+
+        // The reply must still be legal here; the PV came from the search's board copy
+        for ( const Move &move : positionMoves ) {
+            if ( SameMove( move, pv[1] ) ) {
+                Board position = *board;
+                ponderMove = move;
+                position.MakeMove( ponderMove );
+                pondering = true;
+                StartAISearch( position );
+                std::cout << "Pondering on " << move.ToString() << std::endl;
+                return;
             }
+        }
+    }
 
-            std::cout << "AI selected: " << selectedMove.ToString() << " with score: " << bestScore
-                      << " (searched to depth: " << result.depth << ", nodes: " << result.nodesSearched << ")"
-                      << std::endl;
+    // Called after the human's move: keep the ponder search on a hit,
+    // replace it on a miss
+    void OnHumanMove( const Move &move ) {
+        humanMoved = Clock::now();
+        if ( !pondering )
+            return;
+
+        if ( SameMove( move, ponderMove ) ) {
+            pondering = false;
+            ponderHits++;
+            // Saved: the part of the search already done, all of it if it has finished
+            Clock::time_point doneBy = aiDone.load( std::memory_order_acquire ) ? aiFinished : humanMoved;
+            ponderSavedSeconds += std::chrono::duration<double>( doneBy - aiStarted ).count();
+            std::cout << "Ponder hit" << std::endl;
+        } else {
+            CancelAISearch();
+            ponderMisses++;
+        }
+        PrintPonderStats();
+    }
 
-            moveHistory.push_back( selectedMove );
+    void PrintPonderStats() const {
+        int total = ponderHits + ponderMisses;
+        if ( total == 0 )
+            return;
+        std::cout << "Ponder hits: " << ponderHits << "/" << total << " (" << 100 * ponderHits / total
+                  << "%), search time saved: " << TextFormat( "%.2f", ponderSavedSeconds ) << "s total, "
+                  << TextFormat( "%.2f", ponderSavedSeconds / total ) << "s per move" << std::endl;
+    }
 
-            board->MakeMove( selectedMove );
+    static bool SameMove( const Move &a, const Move &b ) {
+        return a.fromSquare == b.fromSquare && a.toSquare == b.toSquare && a.promotedPiece == b.promotedPiece;
+    }
 
-            // Clear any player selection
-            selectedSquare = -1;
-            clickedSquare = -1;
-            legalMoves.clear();
+    // Play the searched move once the worker has finished
+    void PollAISearch() {
+        if ( !aiDone.load( std::memory_order_acquire ) )
+            return;
+        aiThread.join();
+        aiThinking = false;
+        sceneDirty = true;
+        lastSearch = aiResult;
 
-            std::cout << "===================" << std::endl;
+        const std::vector<Move> &moves = positionMoves;
+        if ( moves.empty() ) {
+            std::cout << "Game Over - No legal moves!" << std::endl;
+            return;
         }
+
+        // Take the move from this board's legal list, so its flags match this position
+        Move selectedMove = moves[0];
+        bool found = false;
+        for ( const Move &move : moves ) {
+            if ( SameMove( move, aiResult.bestMove ) ) {
+                selectedMove = move;
+                found = true;
+                break;
+            }
+        }
+        int bestScore = aiResult.score;
+
+        if ( !found ) {
+            std::cout << "SearchEngine returned a default move, falling "
+                         "back to first legal move."
+                      << std::endl;
+        }
+
+        std::cout << "AI selected: " << selectedMove.ToString() << " with score: " << bestScore
+                  << " (searched to depth: " << aiResult.depth << ", nodes: " << aiResult.nodesSearched << ")"
+                  << std::endl;
+
+        // Time the human actually waited, from their move to the search result
+        double searchSeconds = std::chrono::duration<double>( aiFinished - aiStarted ).count();
+        double waitSeconds = std::max( 0.0, std::chrono::duration<double>( aiFinished - humanMoved ).count() );
+        std::cout << "Search took " << TextFormat( "%.2f", searchSeconds ) << "s, reply latency "
+                  << TextFormat( "%.2f", std::min( waitSeconds, searchSeconds ) ) << "s" << std::endl;
+
+        moveHistory.push_back( selectedMove );
+
+        board->MakeMove( selectedMove );
+        OnPositionChanged();
+        StartPondering( aiResult.pv );
+
+        std::cout << "===================" << std::endl;
     }
 
     void HandleMouseInput() {
-        // Don't allow moves if game is over
+        // Don't allow moves if game is over or while the AI is thinking on its own time
         if ( guiGameState == CHECKMATE_WHITE_WINS || guiGameState == CHECKMATE_BLACK_WINS ||
-             guiGameState == STALEMATE ) {
+             guiGameState == STALEMATE || ( aiThinking && !pondering ) ) {
             return;
         }
 
@@ -380,10 +672,9 @@ class ChessGUI {
 
                     selectedSquare = square;
                     legalMoves.clear();
+                    sceneDirty = true;
 
-                    std::vector<Move> allMoves;
-                    GameState::GenerateAllLegalMoves( *board, allMoves, board->whiteToMove );
-                    for ( auto &move : allMoves ) {
+                    for ( auto &move : positionMoves ) {
                         if ( move.fromSquare == selectedSquare ) {
                             legalMoves.push_back( move );
                         }
@@ -392,21 +683,22 @@ class ChessGUI {
                 } else {
                     // Move stage
                     clickedSquare = square;
-                    bool moveMade = false;
-
-                    for ( auto &move : legalMoves ) {
-                        if ( move.toSquare == clickedSquare ) {
-                            moveHistory.push_back( move ); // Save move
-                            board->MakeMove( move );
-                            std::cout << move.ToString() << std::endl;
-                            moveMade = true;
-                            break;
-                        }
+                    auto chosen = std::find_if( legalMoves.begin(), legalMoves.end(),
+                                                [&]( const Move &move ) { return move.toSquare == clickedSquare; } );
+
+                    if ( chosen != legalMoves.end() ) {
+                        Move move = *chosen;
+                        moveHistory.push_back( move ); // Save move
+                        board->MakeMove( move );
+                        std::cout << move.ToString() << std::endl;
+                        OnPositionChanged(); // Also clears the selection
+                        OnHumanMove( move );
+                    } else {
+                        selectedSquare = -1;
+                        clickedSquare = -1;
+                        legalMoves.clear();
+                        sceneDirty = true;
                     }
-
-                    selectedSquare = -1;
-                    clickedSquare = -1;
-                    legalMoves.clear();
                 }
             }
         }
@@ -414,28 +706,23 @@ class ChessGUI {
 
     void HandleKeyboardInput() {
         if ( IsKeyPressed( KEY_U ) ) {
+            CancelAISearch();
             if ( !moveHistory.empty() ) {
                 Move lastMove = moveHistory.back();
                 board->UndoMove( lastMove );
                 moveHistory.pop_back();
                 std::cout << "Undid move: " << lastMove.ToString() << std::endl;
-
-                // Clear any selection state
-                selectedSquare = -1;
-                clickedSquare = -1;
-                legalMoves.clear();
+                OnPositionChanged();
             } else {
                 std::cout << "No moves to undo!" << std::endl;
             }
         }
 
         if ( IsKeyPressed( KEY_R ) ) {
+            CancelAISearch();
             board->Reset();
             moveHistory.clear();
-            selectedSquare = -1;
-            clickedSquare = -1;
-            legalMoves.clear();
-            guiGameState = PLAYING;
+            OnPositionChanged();
             std::cout << "Game restarted!" << std::endl;
         }
 
@@ -453,7 +740,29 @@ class ChessGUI {
         }
 
         if ( IsKeyPressed( KEY_E ) ) {
-            Evaluator::Evaluate( *board );
+            Evaluator::Evaluate( *board, true );
+        }
+
+        if ( IsKeyPressed( KEY_F3 ) ) {
+            hudVisible = !hudVisible;
+        }
+
+        if ( IsKeyPressed( KEY_O ) ) {
+            ponderEnabled = !ponderEnabled;
+            if ( !ponderEnabled && pondering )
+                CancelAISearch();
+            std::cout << "Pondering " << ( ponderEnabled ? "on" : "off" ) << std::endl;
+        }
+
+        if ( IsKeyPressed( KEY_N ) ) {
+            // The evaluator can't change under a running search; it restarts next frame
+            CancelAISearch();
+            if ( NNUE::loaded ) {
+                NNUE::SetEnabled( !NNUE::enabled );
+                std::cout << "NNUE evaluation " << ( NNUE::enabled ? "on" : "off" ) << std::endl;
+            } else {
+                std::cout << "No NNUE network loaded!" << std::endl;
+            }
         }
     }
 };
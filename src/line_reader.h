@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+// ============================================================================
+// Line Reader
+// ============================================================================
+// Newline-framed reading from a socket, for the analysis server and its
+// clients. A trailing carriage return is dropped. Next is false at the end
+// of the stream, on an error, or on a line longer than maxLine (zero for no
+// limit), so a peer cannot make the reader buffer without bound.
+
+class LineReader {
+  public:
+    explicit LineReader( int fd, size_t maxLine = 0 ) : fd( fd ), maxLine( maxLine ) {}
+
+    bool Next( std::string &line ) {
+        while ( true ) {
+            size_t end = buffer.find( '\n', start );
+            if ( end != std::string::npos ) {
+                line.assign( buffer, start, end - start );
+                if ( !line.empty() && line.back() == '\r' )
+                    line.pop_back();
+                start = end + 1;
+                return true;
+            }
+            buffer.erase( 0, start );
+            start = 0;
+            if ( maxLine && buffer.size() > maxLine )
+                return false;
+
+            char chunk[4096];
+            ssize_t received = recv( fd, chunk, sizeof( chunk ), 0 );
+            if ( received < 0 && errno == EINTR )
+                continue;
+            if ( received <= 0 )
+                return false;
+            buffer.append( chunk, received );
+        }
+    }
+
+  private:
+    int fd;
+    size_t maxLine;
+    std::string buffer;
+    size_t start = 0;
+};
@@ -1,7 +1,17 @@
 #include "board.h"
 #include "gui.h"
 
-int main() {
+int main( int argc, char **argv ) {
+    // Optional NNUE network: ./app path/to/network.nnue (toggle with N)
+    if ( argc > 1 ) {
+        if ( NNUE::Load( argv[1] ) ) {
+            NNUE::SetEnabled( true );
+            std::cout << "Loaded NNUE network " << argv[1] << std::endl;
+        } else {
+            std::cout << "Could not load NNUE network " << argv[1] << std::endl;
+        }
+    }
+
     Board board;
     board.LoadFEN( "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1" );
 
@@ -0,0 +1,156 @@
+#pragma once
+
+// ============================================================================
+// Material Signature Table
+// ============================================================================
+// Every decision that depends only on piece counts is precomputed once per
+// material signature: game phase, imbalance bonuses, draw flags, endgame
+// scale factors and specialized endgame evaluators. Board::materialKey
+// indexes the table directly, so the evaluator pays one lookup per call.
+//
+// The table covers up to 2 knights, bishops and rooks and 1 queen per side.
+// Rarer signatures (after underpromotion or a second queen) fall back to an
+// entry computed on the fly.
+
+#include "board.h"
+#include "endgame.h"
+#include "score.h"
+#include <algorithm>
+#include <vector>
+
+struct MaterialEntry {
+    Score imbalance = SCORE_ZERO;               // Pair bonuses (white-relative)
+    uint8_t phase = 0;                          // 0 (endgame) .. MAX_PHASE (middlegame)
+    uint8_t flags = 0;                          // MaterialTable::DRAWN, ...
+    uint8_t scaleFactor[2] = { 64, 64 };        // [stronger side] endgame scale, 64 = normal
+    Endgame::EvaluatorFunc evaluator = nullptr; // Specialized endgame, if any
+    bool strongWhite = true;                    // Side with the mating force for evaluator
+};
+
+class MaterialTable {
+  public:
+    static constexpr uint8_t DRAWN = 1;                 // Dead draw by material alone
+    static constexpr uint8_t DRAWN_IF_SAME_BISHOPS = 2; // KB vs KB, drawn when the bishops share a color
+    static constexpr int SCALE_NORMAL = 64;
+
+    static constexpr Score KNIGHT_PAIR = WeightedScore( 10, 10, PSQT::MATERIAL_WEIGHT );
+    static constexpr Score BISHOP_PAIR = WeightedScore( 30, 30, PSQT::MATERIAL_WEIGHT );
+
+    static constexpr uint32_t SIZE = PSQT::MATERIAL_SIDE_SPAN * PSQT::MATERIAL_SIDE_SPAN;
+
+    // Entry for the board's material signature
+    static const MaterialEntry &Probe( const Board &board ) {
+        if ( InTableRange( board ) )
+            return Table()[board.materialKey];
+
+        thread_local MaterialEntry scratch;
+        scratch = ComputeEntry( board.pieceCount );
+        return scratch;
+    }
+
+    // Work out every material-driven decision for one set of piece counts
+    static MaterialEntry ComputeEntry( const uint8_t pieceCount[12] ) {
+        MaterialEntry entry;
+
+        int phase = 0;
+        for ( int piece = 0; piece < 12; piece++ ) {
+            phase += pieceCount[piece] * PSQT::PHASE_WEIGHTS[piece % 6];
+        }
+        entry.phase = static_cast<uint8_t>( std::min( phase, MAX_PHASE ) );
+
+        // Imbalance: piece pair bonuses
+        if ( pieceCount[WN] >= 2 )
+            entry.imbalance += KNIGHT_PAIR;
+        if ( pieceCount[BN] >= 2 )
+            entry.imbalance -= KNIGHT_PAIR;
+        if ( pieceCount[WB] >= 2 )
+            entry.imbalance += BISHOP_PAIR;
+        if ( pieceCount[BB] >= 2 )
+            entry.imbalance -= BISHOP_PAIR;
+
+        int pawns[2] = { pieceCount[WP], pieceCount[BP] };
+        int minors[2] = { pieceCount[WN] + pieceCount[WB], pieceCount[BN] + pieceCount[BB] };
+        int majors[2] = { pieceCount[WR] + pieceCount[WQ], pieceCount[BR] + pieceCount[BQ] };
+        int nonPawn[2] = { 0, 0 };
+        for ( int type = 1; type < 5; type++ ) {
+            nonPawn[0] += pieceCount[type] * PSQT::PIECE_VALUES[type];
+            nonPawn[1] += pieceCount[type + 6] * PSQT::PIECE_VALUES[type];
+        }
+
+        // Draw flags: neither side can ever mate
+        bool noPawns = pawns[0] == 0 && pawns[1] == 0;
+        bool noMajors = majors[0] == 0 && majors[1] == 0;
+        if ( noPawns && noMajors && minors[0] + minors[1] <= 1 )
+            entry.flags |= DRAWN; // K vs K, KN vs K, KB vs K
+        if ( noPawns && noMajors && pieceCount[WB] == 1 && pieceCount[BB] == 1 && minors[0] + minors[1] == 2 )
+            entry.flags |= DRAWN_IF_SAME_BISHOPS;
+
+        // Scale factors: a side without pawns needs more than a minor piece
+        // of extra material to win, and two knights cannot force mate
+        for ( int side = 0; side < 2; side++ ) {
+            int other = 1 - side;
+            int base = side == 0 ? 0 : 6;
+            if ( pawns[side] == 0 && nonPawn[side] - nonPawn[other] <= PSQT::PIECE_VALUES[2] ) {
+                if ( nonPawn[side] < PSQT::PIECE_VALUES[3] )
+                    entry.scaleFactor[side] = 0;
+                else
+                    entry.scaleFactor[side] = nonPawn[other] <= PSQT::PIECE_VALUES[2] ? 4 : 14;
+            }
+            if ( pawns[side] == 0 && majors[side] == 0 && pieceCount[base + 2] == 0 )
+                entry.scaleFactor[side] = 0;
+        }
+
+        // Specialized endgames against a bare king
+        for ( int side = 0; side < 2; side++ ) {
+            int other = 1 - side;
+            bool weakBare = pawns[other] == 0 && minors[other] == 0 && majors[other] == 0;
+            if ( !weakBare || entry.scaleFactor[side] == 0 )
+                continue;
+
+            int base = side == 0 ? 0 : 6;
+            if ( pawns[side] == 0 && majors[side] == 0 && pieceCount[base + 1] == 1 && pieceCount[base + 2] == 1 ) {
+                entry.evaluator = Endgame::KBNK;
+                entry.strongWhite = side == 0;
+            } else if ( nonPawn[side] >= PSQT::PIECE_VALUES[3] ) {
+                entry.evaluator = Endgame::KXK;
+                entry.strongWhite = side == 0;
+            }
+        }
+
+        return entry;
+    }
+
+  private:
+    // Counts that fit the mixed-radix key without aliasing
+    static bool InTableRange( const Board &board ) {
+        const uint8_t *c = board.pieceCount;
+        return c[WN] <= 2 && c[WB] <= 2 && c[WR] <= 2 && c[WQ] <= 1 && c[BN] <= 2 && c[BB] <= 2 && c[BR] <= 2 &&
+               c[BQ] <= 1;
+    }
+
+    // Built on first use; function-local statics are initialized thread-safely
+    static const std::vector<MaterialEntry> &Table() {
+        static const std::vector<MaterialEntry> table = Build();
+        return table;
+    }
+
+    static std::vector<MaterialEntry> Build() {
+        std::vector<MaterialEntry> table( SIZE );
+        const int limits[6] = { 9, 3, 3, 3, 2, 1 }; // Count range per piece type, kings fixed
+
+        for ( uint32_t key = 0; key < SIZE; key++ ) {
+            uint8_t pieceCount[12] = {};
+            uint32_t rest = key;
+            for ( int piece = 0; piece < 12; piece++ ) {
+                if ( piece % 6 == 5 ) {
+                    pieceCount[piece] = 1;
+                    continue;
+                }
+                pieceCount[piece] = static_cast<uint8_t>( rest % limits[piece % 6] );
+                rest /= limits[piece % 6];
+            }
+            table[key] = ComputeEntry( pieceCount );
+        }
+        return table;
+    }
+};
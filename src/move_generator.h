@@ -6,6 +6,10 @@
 // Stateless move generation functions that operate on a Board reference.
 // All functions append pseudo-legal moves to the provided vector.
 // NOTE: This file must be included AFTER board.h defines the Board class.
+//
+// The generators are templated on the side to move, so every shift, rank
+// mask and piece index is a constant (see ColorTraits). The runtime-bool
+// functions at the bottom pick the instantiation once per call.
 
 #include "attacks.h"
 #include "move.h"
@@ -20,29 +24,29 @@ namespace MoveGen {
 // Attack Detection
 // ============================================================================
 
-inline bool IsSquareAttacked( const Board &board, int square, bool byWhite ) {
-    int base = byWhite ? 0 : 6;
+template <bool ByWhite> inline bool IsSquareAttacked( const Board &board, int square ) {
+    using Them = ColorTraits<ByWhite>;
 
     // Pawn attacks: reverse lookup
-    if ( Attacks::pawnAttacks[byWhite ? 1 : 0][square] & board.bitboards[base] )
+    if ( Attacks::pawnAttacks[Them::THEM][square] & board.bitboards[Them::PAWN] )
         return true;
 
     // Knight attacks
-    if ( Attacks::knightAttacks[square] & board.bitboards[base + 1] )
+    if ( Attacks::knightAttacks[square] & board.bitboards[Them::KNIGHT] )
         return true;
 
     // King attacks
-    if ( Attacks::kingAttacks[square] & board.bitboards[base + 5] )
+    if ( Attacks::kingAttacks[square] & board.bitboards[Them::KING] )
         return true;
 
     // Bishop/Queen (diagonal attacks)
     uint64_t diagonalAttacks = Attacks::GetBishopAttacks( square, board.occupancies[2] );
-    if ( diagonalAttacks & ( board.bitboards[base + 2] | board.bitboards[base + 4] ) )
+    if ( diagonalAttacks & ( board.bitboards[Them::BISHOP] | board.bitboards[Them::QUEEN] ) )
         return true;
 
     // Rook/Queen (straight attacks)
     uint64_t straightAttacks = Attacks::GetRookAttacks( square, board.occupancies[2] );
-    if ( straightAttacks & ( board.bitboards[base + 3] | board.bitboards[base + 4] ) )
+    if ( straightAttacks & ( board.bitboards[Them::ROOK] | board.bitboards[Them::QUEEN] ) )
         return true;
 
     return false;
@@ -52,204 +56,73 @@ inline bool IsSquareAttacked( const Board &board, int square, bool byWhite ) {
 // Pawn Moves
 // ============================================================================
 
-inline void GeneratePawnMoves( const Board &board, std::vector<Move> &moves, bool white ) {
-    uint64_t pawns = board.bitboards[white ? WP : BP];
-    uint64_t empty = ~board.occupancies[2];
-    uint64_t enemies = board.occupancies[white ? 1 : 0];
-
-    int promotionPieces[4] = { white ? WQ : BQ, white ? WR : BR, white ? WB : BB, white ? WN : BN };
-
-    if ( white ) {
-        uint64_t singlePush = ( pawns << 8 ) & empty;
-        uint64_t doublePush = ( ( pawns & RANK_2 ) << 16 ) & empty & ( empty << 8 );
-        uint64_t captureLeft = ( ( pawns & ~FILE_A ) << 7 ) & enemies;
-        uint64_t captureRight = ( ( pawns & ~FILE_H ) << 9 ) & enemies;
-
-        // Single pushes (non-promotion)
-        uint64_t nonPromo = singlePush & ~RANK_8;
-        while ( nonPromo ) {
-            int to = PopLSB( nonPromo );
-            moves.emplace_back( to - 8, to );
-        }
-
-        // Promotions
-        uint64_t promo = singlePush & RANK_8;
-        while ( promo ) {
-            int to = PopLSB( promo );
-            for ( int piece : promotionPieces ) {
-                moves.emplace_back( to - 8, to, false, false, false, true, piece );
-            }
-        }
-
-        // Double pushes
-        while ( doublePush ) {
-            int to = PopLSB( doublePush );
-            moves.emplace_back( to - 16, to );
-        }
-
-        // Captures (non-promotion)
-        uint64_t capLeftNonPromo = captureLeft & ~RANK_8;
-        while ( capLeftNonPromo ) {
-            int to = PopLSB( capLeftNonPromo );
-            moves.emplace_back( to - 7, to, true );
-        }
-
-        uint64_t capRightNonPromo = captureRight & ~RANK_8;
-        while ( capRightNonPromo ) {
-            int to = PopLSB( capRightNonPromo );
-            moves.emplace_back( to - 9, to, true );
-        }
-
-        // Capture promotions
-        uint64_t capLeftPromo = captureLeft & RANK_8;
-        while ( capLeftPromo ) {
-            int to = PopLSB( capLeftPromo );
-            for ( int piece : promotionPieces ) {
-                moves.emplace_back( to - 7, to, true, false, false, true, piece );
-            }
-        }
-
-        uint64_t capRightPromo = captureRight & RANK_8;
-        while ( capRightPromo ) {
-            int to = PopLSB( capRightPromo );
-            for ( int piece : promotionPieces ) {
-                moves.emplace_back( to - 9, to, true, false, false, true, piece );
-            }
-        }
-
-    } else {
-        uint64_t singlePush = ( pawns >> 8 ) & empty;
-        uint64_t doublePush = ( ( pawns & RANK_7 ) >> 16 ) & empty & ( empty >> 8 );
-        uint64_t captureLeft = ( ( pawns & ~FILE_A ) >> 9 ) & enemies;
-        uint64_t captureRight = ( ( pawns & ~FILE_H ) >> 7 ) & enemies;
-
-        uint64_t nonPromo = singlePush & ~RANK_1;
-        while ( nonPromo ) {
-            int to = PopLSB( nonPromo );
-            moves.emplace_back( to + 8, to );
-        }
-
-        uint64_t promo = singlePush & RANK_1;
-        while ( promo ) {
-            int to = PopLSB( promo );
-            for ( int piece : promotionPieces ) {
-                moves.emplace_back( to + 8, to, false, false, false, true, piece );
-            }
-        }
-
-        while ( doublePush ) {
-            int to = PopLSB( doublePush );
-            moves.emplace_back( to + 16, to );
-        }
-
-        uint64_t capLeftNonPromo = captureLeft & ~RANK_1;
-        while ( capLeftNonPromo ) {
-            int to = PopLSB( capLeftNonPromo );
-            moves.emplace_back( to + 9, to, true );
-        }
-
-        uint64_t capRightNonPromo = captureRight & ~RANK_1;
-        while ( capRightNonPromo ) {
-            int to = PopLSB( capRightNonPromo );
-            moves.emplace_back( to + 7, to, true );
-        }
-
-        uint64_t capLeftPromo = captureLeft & RANK_1;
-        while ( capLeftPromo ) {
-            int to = PopLSB( capLeftPromo );
-            for ( int piece : promotionPieces ) {
-                moves.emplace_back( to + 9, to, true, false, false, true, piece );
-            }
-        }
-
-        uint64_t capRightPromo = captureRight & RANK_1;
-        while ( capRightPromo ) {
-            int to = PopLSB( capRightPromo );
-            for ( int piece : promotionPieces ) {
-                moves.emplace_back( to + 7, to, true, false, false, true, piece );
-            }
-        }
+// One move per target square; offset is the distance travelled
+inline void AddPawnMoves( std::vector<Move> &moves, uint64_t targets, int offset, bool capture ) {
+    while ( targets ) {
+        int to = PopLSB( targets );
+        moves.emplace_back( to - offset, to, capture );
     }
 }
 
-// ============================================================================
-// Knight Moves
-// ============================================================================
-
-inline void GenerateKnightMoves( const Board &board, std::vector<Move> &moves, bool white ) {
-    uint64_t knights = board.bitboards[white ? WN : BN];
-    uint64_t friendly = board.occupancies[white ? 0 : 1];
-    uint64_t enemies = board.occupancies[white ? 1 : 0];
-
-    while ( knights ) {
-        int from = PopLSB( knights );
-        uint64_t targets = Attacks::knightAttacks[from] & ~friendly;
-
-        while ( targets ) {
-            int to = PopLSB( targets );
-            bool isCapture = enemies & ( 1ULL << to );
-            moves.emplace_back( from, to, isCapture );
+// Four moves per target square, queen first
+template <bool White>
+inline void AddPromotions( std::vector<Move> &moves, uint64_t targets, int offset, bool capture ) {
+    using Us = ColorTraits<White>;
+    while ( targets ) {
+        int to = PopLSB( targets );
+        for ( int piece : { Us::QUEEN, Us::ROOK, Us::BISHOP, Us::KNIGHT } ) {
+            moves.emplace_back( to - offset, to, capture, false, false, true, piece );
         }
     }
 }
 
-// ============================================================================
-// Bishop Moves
-// ============================================================================
-
-inline void GenerateBishopMoves( const Board &board, std::vector<Move> &moves, bool white ) {
-    uint64_t bishops = board.bitboards[white ? WB : BB];
-    uint64_t friendly = board.occupancies[white ? 0 : 1];
-    uint64_t enemies = board.occupancies[white ? 1 : 0];
-
-    while ( bishops ) {
-        int from = PopLSB( bishops );
-        uint64_t attacks = Attacks::GetBishopAttacks( from, board.occupancies[2] );
-        uint64_t targets = attacks & ~friendly;
-
-        while ( targets ) {
-            int to = PopLSB( targets );
-            bool isCapture = enemies & ( 1ULL << to );
-            moves.emplace_back( from, to, isCapture );
-        }
-    }
+template <bool White> inline void GeneratePawnMoves( const Board &board, std::vector<Move> &moves ) {
+    using Us = ColorTraits<White>;
+    uint64_t pawns = board.bitboards[Us::PAWN];
+    uint64_t empty = ~board.occupancies[2];
+    uint64_t enemies = board.occupancies[Us::THEM];
+
+    uint64_t singlePush = Shift<Us::UP>( pawns ) & empty;
+    uint64_t doublePush = Shift<Us::UP>( singlePush & Us::DOUBLE_PUSH_RANK ) & empty;
+    uint64_t captureLeft = Shift<Us::UP_LEFT>( pawns & ~FILE_A ) & enemies;
+    uint64_t captureRight = Shift<Us::UP_RIGHT>( pawns & ~FILE_H ) & enemies;
+
+    // Pushes, promotions, then captures
+    AddPawnMoves( moves, singlePush & ~Us::PROMOTION_RANK, Us::UP, false );
+    AddPromotions<White>( moves, singlePush & Us::PROMOTION_RANK, Us::UP, false );
+    AddPawnMoves( moves, doublePush, 2 * Us::UP, false );
+
+    AddPawnMoves( moves, captureLeft & ~Us::PROMOTION_RANK, Us::UP_LEFT, true );
+    AddPawnMoves( moves, captureRight & ~Us::PROMOTION_RANK, Us::UP_RIGHT, true );
+    AddPromotions<White>( moves, captureLeft & Us::PROMOTION_RANK, Us::UP_LEFT, true );
+    AddPromotions<White>( moves, captureRight & Us::PROMOTION_RANK, Us::UP_RIGHT, true );
 }
 
 // ============================================================================
-// Rook Moves
+// Knight, Bishop, Rook and Queen Moves
 // ============================================================================
 
-inline void GenerateRookMoves( const Board &board, std::vector<Move> &moves, bool white ) {
-    uint64_t rooks = board.bitboards[white ? WR : BR];
-    uint64_t friendly = board.occupancies[white ? 0 : 1];
-    uint64_t enemies = board.occupancies[white ? 1 : 0];
-
-    while ( rooks ) {
-        int from = PopLSB( rooks );
-        uint64_t attacks = Attacks::GetRookAttacks( from, board.occupancies[2] );
-        uint64_t targets = attacks & ~friendly;
-
-        while ( targets ) {
-            int to = PopLSB( targets );
-            bool isCapture = enemies & ( 1ULL << to );
-            moves.emplace_back( from, to, isCapture );
-        }
-    }
+// Attacks of a non-pawn piece type (white index) from a square
+template <int Type> inline uint64_t PieceAttacks( int square, uint64_t occupied ) {
+    if constexpr ( Type == WN )
+        return Attacks::knightAttacks[square];
+    else if constexpr ( Type == WB )
+        return Attacks::GetBishopAttacks( square, occupied );
+    else if constexpr ( Type == WR )
+        return Attacks::GetRookAttacks( square, occupied );
+    else
+        return Attacks::GetQueenAttacks( square, occupied );
 }
 
-// ============================================================================
-// Queen Moves
-// ============================================================================
+template <bool White, int Type> inline void GeneratePieceMoves( const Board &board, std::vector<Move> &moves ) {
+    using Us = ColorTraits<White>;
+    uint64_t pieces = board.bitboards[Us::PAWN + Type];
+    uint64_t friendly = board.occupancies[Us::US];
+    uint64_t enemies = board.occupancies[Us::THEM];
 
-inline void GenerateQueenMoves( const Board &board, std::vector<Move> &moves, bool white ) {
-    uint64_t queens = board.bitboards[white ? WQ : BQ];
-    uint64_t friendly = board.occupancies[white ? 0 : 1];
-    uint64_t enemies = board.occupancies[white ? 1 : 0];
-
-    while ( queens ) {
-        int from = PopLSB( queens );
-        uint64_t attacks = Attacks::GetQueenAttacks( from, board.occupancies[2] );
-        uint64_t targets = attacks & ~friendly;
+    while ( pieces ) {
+        int from = PopLSB( pieces );
+        uint64_t targets = PieceAttacks<Type>( from, board.occupancies[2] ) & ~friendly;
 
         while ( targets ) {
             int to = PopLSB( targets );
@@ -263,59 +136,43 @@ inline void GenerateQueenMoves( const Board &board, std::vector<Move> &moves, bo
 // King Moves
 // ============================================================================
 
-inline void GenerateKingMoves( const Board &board, std::vector<Move> &moves, bool white ) {
-    uint64_t kings = board.bitboards[white ? WK : BK];
+template <bool White> inline void GenerateKingMoves( const Board &board, std::vector<Move> &moves ) {
+    using Us = ColorTraits<White>;
+    uint64_t kings = board.bitboards[Us::KING];
     if ( !kings )
         return;
 
     int kingSquare = BitScanForward( kings );
-    uint64_t friendly = board.occupancies[white ? 0 : 1];
-    uint64_t enemies = board.occupancies[white ? 1 : 0];
+    uint64_t friendly = board.occupancies[Us::US];
+    uint64_t enemies = board.occupancies[Us::THEM];
 
     uint64_t targets = Attacks::kingAttacks[kingSquare] & ~friendly;
 
     while ( targets ) {
         int to = PopLSB( targets );
-        if ( !IsSquareAttacked( board, to, !white ) ) {
+        if ( !IsSquareAttacked<!White>( board, to ) ) {
             bool isCapture = enemies & ( 1ULL << to );
             moves.emplace_back( kingSquare, to, isCapture );
         }
     }
 
-    // Castling
-    if ( white ) {
-        if ( board.castlingRights & CASTLE_WK ) {
-            bool emptyBetween = !( board.occupancies[2] & ( ( 1ULL << F1 ) | ( 1ULL << G1 ) ) );
-            bool safe = !IsSquareAttacked( board, E1, false ) && !IsSquareAttacked( board, F1, false ) &&
-                        !IsSquareAttacked( board, G1, false );
-            if ( emptyBetween && safe ) {
-                moves.emplace_back( E1, G1, false, false, true );
-            }
-        }
-        if ( board.castlingRights & CASTLE_WQ ) {
-            bool emptyBetween = !( board.occupancies[2] & ( ( 1ULL << D1 ) | ( 1ULL << C1 ) | ( 1ULL << B1 ) ) );
-            bool safe = !IsSquareAttacked( board, E1, false ) && !IsSquareAttacked( board, D1, false ) &&
-                        !IsSquareAttacked( board, C1, false );
-            if ( emptyBetween && safe ) {
-                moves.emplace_back( E1, C1, false, false, true );
-            }
+    // Castling: the king's start, path and target must not be attacked
+    constexpr int start = Us::KING_START;
+    if ( board.castlingRights & Us::CASTLE_KINGSIDE ) {
+        bool emptyBetween = !( board.occupancies[2] & ( ( 1ULL << ( start + 1 ) ) | ( 1ULL << ( start + 2 ) ) ) );
+        bool safe = !IsSquareAttacked<!White>( board, start ) && !IsSquareAttacked<!White>( board, start + 1 ) &&
+                    !IsSquareAttacked<!White>( board, start + 2 );
+        if ( emptyBetween && safe ) {
+            moves.emplace_back( start, Us::KINGSIDE_TARGET, false, false, true );
         }
-    } else {
-        if ( board.castlingRights & CASTLE_BK ) {
-            bool emptyBetween = !( board.occupancies[2] & ( ( 1ULL << F8 ) | ( 1ULL << G8 ) ) );
-            bool safe = !IsSquareAttacked( board, E8, true ) && !IsSquareAttacked( board, F8, true ) &&
-                        !IsSquareAttacked( board, G8, true );
-            if ( emptyBetween && safe ) {
-                moves.emplace_back( E8, G8, false, false, true );
-            }
-        }
-        if ( board.castlingRights & CASTLE_BQ ) {
-            bool emptyBetween = !( board.occupancies[2] & ( ( 1ULL << D8 ) | ( 1ULL << C8 ) | ( 1ULL << B8 ) ) );
-            bool safe = !IsSquareAttacked( board, E8, true ) && !IsSquareAttacked( board, D8, true ) &&
-                        !IsSquareAttacked( board, C8, true );
-            if ( emptyBetween && safe ) {
-                moves.emplace_back( E8, C8, false, false, true );
-            }
+    }
+    if ( board.castlingRights & Us::CASTLE_QUEENSIDE ) {
+        bool emptyBetween = !( board.occupancies[2] &
+                               ( ( 1ULL << ( start - 1 ) ) | ( 1ULL << ( start - 2 ) ) | ( 1ULL << ( start - 3 ) ) ) );
+        bool safe = !IsSquareAttacked<!White>( board, start ) && !IsSquareAttacked<!White>( board, start - 1 ) &&
+                    !IsSquareAttacked<!White>( board, start - 2 );
+        if ( emptyBetween && safe ) {
+            moves.emplace_back( start, Us::QUEENSIDE_TARGET, false, false, true );
         }
     }
 }
@@ -324,13 +181,25 @@ inline void GenerateKingMoves( const Board &board, std::vector<Move> &moves, boo
 // All Pseudo-Legal Moves
 // ============================================================================
 
+template <bool White> inline void GenerateAllPseudoLegal( const Board &board, std::vector<Move> &moves ) {
+    GeneratePawnMoves<White>( board, moves );
+    GeneratePieceMoves<White, WN>( board, moves );
+    GeneratePieceMoves<White, WB>( board, moves );
+    GeneratePieceMoves<White, WR>( board, moves );
+    GeneratePieceMoves<White, WQ>( board, moves );
+    GenerateKingMoves<White>( board, moves );
+}
+
+// ============================================================================
+// Runtime Dispatch
+// ============================================================================
+
+inline bool IsSquareAttacked( const Board &board, int square, bool byWhite ) {
+    return byWhite ? IsSquareAttacked<true>( board, square ) : IsSquareAttacked<false>( board, square );
+}
+
 inline void GenerateAllPseudoLegal( const Board &board, std::vector<Move> &moves, bool white ) {
-    GeneratePawnMoves( board, moves, white );
-    GenerateKnightMoves( board, moves, white );
-    GenerateBishopMoves( board, moves, white );
-    GenerateRookMoves( board, moves, white );
-    GenerateQueenMoves( board, moves, white );
-    GenerateKingMoves( board, moves, white );
+    white ? GenerateAllPseudoLegal<true>( board, moves ) : GenerateAllPseudoLegal<false>( board, moves );
 }
 
 } // namespace MoveGen
@@ -0,0 +1,472 @@
+#pragma once
+
+// ============================================================================
+// NNUE - Efficiently Updatable Neural Network Evaluation
+// ============================================================================
+// Optional replacement for the handcrafted terms of Evaluator::Evaluate.
+//
+// Architecture: HalfKP (40960) -> 2 x 128 -> 32 -> 32 -> 1
+//
+//   - Input features are (own king square, piece, square) triples for every
+//     non-king piece, seen from each side's perspective. Black's perspective
+//     is rank-flipped so both halves share one weight matrix.
+//   - The first layer is an int16 "accumulator" per perspective, kept up to
+//     date incrementally in a ply-indexed AccumulatorStack owned by the
+//     search, not by the Board: each move played pushes its piece changes
+//     and the next evaluation applies them, one column subtracted and one
+//     added per quiet move. A king move rebuilds that side's half instead.
+//   - The dense layers use int8 weights and int32 sums. AVX2 kernels are used
+//     when compiled with -mavx2 (or -march=native); the scalar fallback gives
+//     bit-identical results.
+//
+// No network ships with the engine. Load() reads one from disk and
+// SetEnabled() switches Evaluator::Evaluate over to it.
+//
+// File format (little-endian):
+//   char[4] "CHNN", uint32 version (1), uint32 L1, uint32 L2, uint32 L3
+//   int16 ftBiases[L1], int16 ftWeights[INPUTS][L1]
+//   int32 l1Biases[L2], int8 l1Weights[L2][2 * L1]
+//   int32 l2Biases[L3], int8 l2Weights[L3][L2]
+//   int32 outBias,      int8 outWeights[L3]
+
+#include "bitboard.h"
+#include "board.h"
+#include "move.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+
+namespace NNUE {
+
+// ============================================================================
+// Architecture
+// ============================================================================
+
+constexpr int PIECE_PLANES = 10; // Own and enemy P, N, B, R, Q
+constexpr int INPUTS = 64 * PIECE_PLANES * 64;
+constexpr int L1 = 128; // Accumulator size per perspective
+constexpr int L2 = 32;
+constexpr int L3 = 32;
+
+constexpr int QUANT_SHIFT = 6;   // Hidden layer output: sum >> QUANT_SHIFT, clipped to 0..127
+constexpr int OUTPUT_SCALE = 16; // Network output units per centipawn
+
+constexpr uint32_t FILE_VERSION = 1;
+
+// Feature index of a non-king piece on a square, from one perspective
+inline int FeatureIndex( int perspective, int kingSquare, int piece, int square ) {
+    int orient = perspective == WHITE_SIDE ? 0 : 56;
+    bool own = ( piece < 6 ) == ( perspective == WHITE_SIDE );
+    int plane = ( own ? 0 : 5 ) + piece % 6;
+    return ( ( ( kingSquare ^ orient ) * PIECE_PLANES + plane ) * 64 ) + ( square ^ orient );
+}
+
+// ============================================================================
+// Network
+// ============================================================================
+
+struct Network {
+    std::vector<int16_t> ftBiases;  // [L1]
+    std::vector<int16_t> ftWeights; // [INPUTS][L1]
+    std::vector<int32_t> l1Biases;  // [L2]
+    std::vector<int8_t> l1Weights;  // [L2][2 * L1]
+    std::vector<int32_t> l2Biases;  // [L3]
+    std::vector<int8_t> l2Weights;  // [L3][L2]
+    int32_t outBias = 0;
+    std::vector<int8_t> outWeights; // [L3]
+
+    void Allocate() {
+        ftBiases.assign( L1, 0 );
+        ftWeights.assign( static_cast<size_t>( INPUTS ) * L1, 0 );
+        l1Biases.assign( L2, 0 );
+        l1Weights.assign( L2 * 2 * L1, 0 );
+        l2Biases.assign( L3, 0 );
+        l2Weights.assign( L3 * L2, 0 );
+        outWeights.assign( L3, 0 );
+    }
+};
+
+inline Network network;
+inline std::atomic<bool> loaded{ false };
+inline std::atomic<bool> enabled{ false };
+inline std::atomic<uint64_t> networkId{ 0 }; // New with every network installed; 0 before the first
+
+// Searches hold this shared for as long as they run; installing a network
+// takes it exclusively, so the weights never change under a search
+inline std::shared_mutex networkMutex;
+
+// Identifies the current network, so cached evaluations of another are told apart
+inline uint64_t NetworkId() { return networkId.load( std::memory_order_relaxed ); }
+
+// True when evaluation should use the network (loaded and switched on)
+inline bool IsActive() { return enabled.load( std::memory_order_relaxed ) && loaded.load( std::memory_order_relaxed ); }
+
+// Runtime switch between the network and the classic evaluation. A search
+// that sees it switched on rebuilds its accumulators on first use.
+inline void SetEnabled( bool on ) { enabled.store( on, std::memory_order_relaxed ); }
+
+template <typename T> bool ReadArray( std::ifstream &in, std::vector<T> &data ) {
+    in.read( reinterpret_cast<char *>( data.data() ), static_cast<std::streamsize>( data.size() * sizeof( T ) ) );
+    return static_cast<bool>( in );
+}
+
+template <typename T> void WriteArray( std::ofstream &out, const std::vector<T> &data ) {
+    out.write( reinterpret_cast<const char *>( data.data() ),
+               static_cast<std::streamsize>( data.size() * sizeof( T ) ) );
+}
+
+// Make fresh the current network; false, keeping the old one, while a
+// search is running
+inline bool Install( Network &fresh ) {
+    std::unique_lock<std::shared_mutex> lock( networkMutex, std::try_to_lock );
+    if ( !lock.owns_lock() )
+        return false;
+    network = std::move( fresh );
+    networkId.fetch_add( 1, std::memory_order_relaxed );
+    loaded = true;
+    return true;
+}
+
+// Read a network file. On failure, or while a search is running, the
+// previous network stays in place.
+inline bool Load( const std::string &path ) {
+    std::ifstream in( path, std::ios::binary );
+    if ( !in )
+        return false;
+
+    char magic[4];
+    uint32_t header[4];
+    in.read( magic, 4 );
+    in.read( reinterpret_cast<char *>( header ), sizeof( header ) );
+    if ( !in || memcmp( magic, "CHNN", 4 ) != 0 || header[0] != FILE_VERSION || header[1] != L1 ||
+         header[2] != L2 || header[3] != L3 )
+        return false;
+
+    Network fresh;
+    fresh.Allocate();
+    bool ok = ReadArray( in, fresh.ftBiases ) && ReadArray( in, fresh.ftWeights ) && ReadArray( in, fresh.l1Biases ) &&
+              ReadArray( in, fresh.l1Weights ) && ReadArray( in, fresh.l2Biases ) && ReadArray( in, fresh.l2Weights );
+    in.read( reinterpret_cast<char *>( &fresh.outBias ), sizeof( fresh.outBias ) );
+    ok = ok && in && ReadArray( in, fresh.outWeights );
+    return ok && Install( fresh );
+}
+
+// Write the current network in the format Load() reads
+inline bool Save( const std::string &path ) {
+    std::shared_lock<std::shared_mutex> lock( networkMutex );
+    std::ofstream out( path, std::ios::binary );
+    if ( !out )
+        return false;
+
+    const uint32_t header[4] = { FILE_VERSION, L1, L2, L3 };
+    out.write( "CHNN", 4 );
+    out.write( reinterpret_cast<const char *>( header ), sizeof( header ) );
+    WriteArray( out, network.ftBiases );
+    WriteArray( out, network.ftWeights );
+    WriteArray( out, network.l1Biases );
+    WriteArray( out, network.l1Weights );
+    WriteArray( out, network.l2Biases );
+    WriteArray( out, network.l2Weights );
+    out.write( reinterpret_cast<const char *>( &network.outBias ), sizeof( network.outBias ) );
+    WriteArray( out, network.outWeights );
+    return static_cast<bool>( out );
+}
+
+// Fill the network with small pseudo-random weights (benchmarks and tests);
+// false while a search is running, as for Load
+inline bool InitRandom( uint64_t seed ) {
+    Network fresh;
+    fresh.Allocate();
+    auto next = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+    for ( auto &w : fresh.ftBiases )
+        w = static_cast<int16_t>( next() % 64 );
+    for ( auto &w : fresh.ftWeights )
+        w = static_cast<int16_t>( static_cast<int>( next() % 33 ) - 16 );
+    for ( auto &w : fresh.l1Biases )
+        w = static_cast<int32_t>( next() % 256 ) - 128;
+    for ( auto &w : fresh.l1Weights )
+        w = static_cast<int8_t>( static_cast<int>( next() % 17 ) - 8 );
+    for ( auto &w : fresh.l2Biases )
+        w = static_cast<int32_t>( next() % 256 ) - 128;
+    for ( auto &w : fresh.l2Weights )
+        w = static_cast<int8_t>( static_cast<int>( next() % 33 ) - 16 );
+    fresh.outBias = 0;
+    for ( auto &w : fresh.outWeights )
+        w = static_cast<int8_t>( static_cast<int>( next() % 65 ) - 32 );
+    return Install( fresh );
+}
+
+// ============================================================================
+// Accumulator
+// ============================================================================
+
+constexpr int MAX_CHANGES = 3; // Piece changes of one move; a capturing promotion has three
+
+struct Accumulator {
+    struct Change {
+        int8_t piece, from, to; // -1 square: piece added or removed
+    };
+
+    alignas( 32 ) int16_t values[2][L1]; // [perspective] first-layer sums
+    bool computed[2] = { false, false }; // False: not brought up to date yet
+    Change changes[MAX_CHANGES];         // The move from the previous ply to this one
+    int changeCount = 0;
+};
+
+// values += column(add) - column(sub); either index may be -1 to skip it
+inline void UpdateColumns( int16_t *values, int addIndex, int subIndex ) {
+    const int16_t *add = addIndex >= 0 ? &network.ftWeights[static_cast<size_t>( addIndex ) * L1] : nullptr;
+    const int16_t *sub = subIndex >= 0 ? &network.ftWeights[static_cast<size_t>( subIndex ) * L1] : nullptr;
+
+#if defined( __AVX2__ )
+    for ( int i = 0; i < L1; i += 16 ) {
+        __m256i v = _mm256_load_si256( reinterpret_cast<const __m256i *>( values + i ) );
+        if ( add )
+            v = _mm256_add_epi16( v, _mm256_loadu_si256( reinterpret_cast<const __m256i *>( add + i ) ) );
+        if ( sub )
+            v = _mm256_sub_epi16( v, _mm256_loadu_si256( reinterpret_cast<const __m256i *>( sub + i ) ) );
+        _mm256_store_si256( reinterpret_cast<__m256i *>( values + i ), v );
+    }
+#else
+    for ( int i = 0; i < L1; i++ ) {
+        int v = values[i];
+        if ( add )
+            v += add[i];
+        if ( sub )
+            v -= sub[i];
+        values[i] = static_cast<int16_t>( v );
+    }
+#endif
+}
+
+// Rebuild one perspective from the piece bitboards
+inline void Refresh( Accumulator &acc, int perspective, const uint64_t bitboards[12] ) {
+    int16_t *values = acc.values[perspective];
+    memcpy( values, network.ftBiases.data(), sizeof( acc.values[perspective] ) );
+
+    int kingSquare = BitScanForward( bitboards[perspective == WHITE_SIDE ? WK : BK] );
+    for ( int piece = 0; piece < 12; piece++ ) {
+        if ( piece % 6 == 5 )
+            continue;
+        uint64_t pieces = bitboards[piece];
+        while ( pieces ) {
+            int square = PopLSB( pieces );
+            UpdateColumns( values, FeatureIndex( perspective, kingSquare, piece, square ), -1 );
+        }
+    }
+    acc.computed[perspective] = true;
+}
+
+// ============================================================================
+// Accumulator Stack
+// ============================================================================
+// The accumulators of one search, indexed by ply: entry 0 is the root and
+// entry ply the position after the ply-th move of the current line. Push
+// only records the move's piece changes; an entry is brought up to date
+// when its position is evaluated, from the nearest computed entry below it.
+
+class AccumulatorStack {
+  public:
+    explicit AccumulatorStack( size_t plies = 1 ) : entries( std::max<size_t>( plies, 1 ) ) {}
+
+    // Start a line at root; its accumulator is built at once while NNUE is on
+    void Reset( const Board &root ) {
+        ply = 0;
+        Accumulator &acc = entries[0];
+        acc.computed[WHITE_SIDE] = acc.computed[BLACK_SIDE] = false;
+        acc.changeCount = 0;
+        if ( IsActive() ) {
+            Refresh( acc, WHITE_SIDE, root.bitboards );
+            Refresh( acc, BLACK_SIDE, root.bitboards );
+        }
+    }
+
+    // Record move, just made on board. Done whether or not NNUE is on, so
+    // switching it on mid-search finds every entry's changes.
+    void Push( const Board &board, const Move &move ) {
+        if ( ++ply == static_cast<int>( entries.size() ) )
+            entries.emplace_back();
+        Accumulator &acc = entries[ply];
+        acc.computed[WHITE_SIDE] = acc.computed[BLACK_SIDE] = false;
+        acc.changeCount = 0;
+
+        if ( move.capturedPieceType != NO_PIECE )
+            Add( acc, move.capturedPieceType, move.toSquare, -1 );
+        if ( move.isPromotion && move.promotedPiece != NO_PIECE ) {
+            Add( acc, board.whiteToMove ? BP : WP, move.fromSquare, -1 );
+            Add( acc, move.promotedPiece, -1, move.toSquare );
+        } else {
+            Add( acc, board.mailbox[move.toSquare], move.fromSquare, move.toSquare );
+            if ( move.isCastling )
+                Add( acc, board.mailbox[move.rookTo], move.rookFrom, move.rookTo );
+        }
+    }
+
+    void Pop() { ply--; }
+
+    // Accumulator of the current ply, brought up to date for its position.
+    // Kings are not features, so the changes since the nearest computed ply
+    // are applied with the current king square; a perspective whose own king
+    // moved in between is rebuilt instead.
+    const Accumulator &Update( const uint64_t bitboards[12] ) {
+        for ( int perspective = 0; perspective < 2; perspective++ ) {
+            int ownKing = perspective == WHITE_SIDE ? WK : BK;
+            int base = ply;
+            while ( !entries[base].computed[perspective] && base > 0 && !MovesPiece( entries[base], ownKing ) )
+                base--;
+            if ( !entries[base].computed[perspective] ) {
+                Refresh( entries[ply], perspective, bitboards );
+                continue;
+            }
+
+            int kingSquare = BitScanForward( bitboards[ownKing] );
+            for ( int next = base + 1; next <= ply; next++ ) {
+                Accumulator &acc = entries[next];
+                memcpy( acc.values[perspective], entries[next - 1].values[perspective],
+                        sizeof( acc.values[perspective] ) );
+                for ( int i = 0; i < acc.changeCount; i++ ) {
+                    const Accumulator::Change &change = acc.changes[i];
+                    if ( change.piece % 6 == 5 )
+                        continue; // Enemy king
+                    UpdateColumns(
+                        acc.values[perspective],
+                        change.to >= 0 ? FeatureIndex( perspective, kingSquare, change.piece, change.to ) : -1,
+                        change.from >= 0 ? FeatureIndex( perspective, kingSquare, change.piece, change.from ) : -1 );
+                }
+                acc.computed[perspective] = true;
+            }
+        }
+        return entries[ply];
+    }
+
+  private:
+    std::vector<Accumulator> entries; // [ply], grown when a line runs deeper
+    int ply = 0;
+
+    static void Add( Accumulator &acc, int piece, int from, int to ) {
+        acc.changes[acc.changeCount++] = { static_cast<int8_t>( piece ), static_cast<int8_t>( from ),
+                                           static_cast<int8_t>( to ) };
+    }
+
+    static bool MovesPiece( const Accumulator &acc, int piece ) {
+        for ( int i = 0; i < acc.changeCount; i++ ) {
+            if ( acc.changes[i].piece == piece )
+                return true;
+        }
+        return false;
+    }
+};
+
+// ============================================================================
+// Forward Pass
+// ============================================================================
+
+inline int8_t ClipToInt8( int v ) { return static_cast<int8_t>( v < 0 ? 0 : ( v > 127 ? 127 : v ) ); }
+
+// Clipped ReLU of both accumulator halves, side to move first
+inline void TransformFeatures( const Accumulator &acc, bool whiteToMove, uint8_t *output ) {
+    const int16_t *halves[2] = { acc.values[whiteToMove ? WHITE_SIDE : BLACK_SIDE],
+                                 acc.values[whiteToMove ? BLACK_SIDE : WHITE_SIDE] };
+    for ( int h = 0; h < 2; h++ ) {
+#if defined( __AVX2__ )
+        const __m256i zero = _mm256_setzero_si256();
+        for ( int i = 0; i < L1; i += 32 ) {
+            __m256i a = _mm256_load_si256( reinterpret_cast<const __m256i *>( halves[h] + i ) );
+            __m256i b = _mm256_load_si256( reinterpret_cast<const __m256i *>( halves[h] + i + 16 ) );
+            // packs saturates to -128..127 per 128-bit lane; restore order, then clip at 0
+            __m256i packed = _mm256_permute4x64_epi64( _mm256_packs_epi16( a, b ), 0xD8 );
+            _mm256_storeu_si256( reinterpret_cast<__m256i *>( output + h * L1 + i ), _mm256_max_epi8( packed, zero ) );
+        }
+#else
+        for ( int i = 0; i < L1; i++ ) {
+            output[h * L1 + i] = static_cast<uint8_t>( ClipToInt8( halves[h][i] ) );
+        }
+#endif
+    }
+}
+
+// Dense layer: out[o] = bias[o] + sum(in[i] * w[o][i]). inputs must be a multiple of 32.
+inline void AffineLayer( const uint8_t *input, int inputs, const int8_t *weights, const int32_t *biases,
+                         int outputs, int32_t *output ) {
+#if defined( __AVX2__ )
+    const __m256i ones = _mm256_set1_epi16( 1 );
+    for ( int o = 0; o < outputs; o++ ) {
+        __m256i sum = _mm256_setzero_si256();
+        const int8_t *row = weights + o * inputs;
+        for ( int i = 0; i < inputs; i += 32 ) {
+            __m256i in = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( input + i ) );
+            __m256i w = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( row + i ) );
+            // u8 x i8 pairs -> i16 (inputs <= 127, so no saturation), then pairs -> i32
+            sum = _mm256_add_epi32( sum, _mm256_madd_epi16( _mm256_maddubs_epi16( in, w ), ones ) );
+        }
+        __m128i s = _mm_add_epi32( _mm256_castsi256_si128( sum ), _mm256_extracti128_si256( sum, 1 ) );
+        s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0x4E ) );
+        s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0xB1 ) );
+        output[o] = biases[o] + _mm_cvtsi128_si32( s );
+    }
+#else
+    for ( int o = 0; o < outputs; o++ ) {
+        int32_t sum = biases[o];
+        const int8_t *row = weights + o * inputs;
+        for ( int i = 0; i < inputs; i++ ) {
+            sum += static_cast<int32_t>( input[i] ) * row[i];
+        }
+        output[o] = sum;
+    }
+#endif
+}
+
+// Network output in centipawns, from the side to move's point of view
+inline int Evaluate( const Accumulator &acc, bool whiteToMove ) {
+    alignas( 32 ) uint8_t transformed[2 * L1];
+    alignas( 32 ) int32_t hidden1[L2];
+    alignas( 32 ) uint8_t clipped1[L2];
+    alignas( 32 ) int32_t hidden2[L3];
+    alignas( 32 ) uint8_t clipped2[L3];
+
+    TransformFeatures( acc, whiteToMove, transformed );
+
+    AffineLayer( transformed, 2 * L1, network.l1Weights.data(), network.l1Biases.data(), L2, hidden1 );
+    for ( int i = 0; i < L2; i++ )
+        clipped1[i] = static_cast<uint8_t>( ClipToInt8( hidden1[i] >> QUANT_SHIFT ) );
+
+    AffineLayer( clipped1, L2, network.l2Weights.data(), network.l2Biases.data(), L3, hidden2 );
+    for ( int i = 0; i < L3; i++ )
+        clipped2[i] = static_cast<uint8_t>( ClipToInt8( hidden2[i] >> QUANT_SHIFT ) );
+
+    int32_t output = network.outBias;
+    for ( int i = 0; i < L3; i++ )
+        output += static_cast<int32_t>( clipped2[i] ) * network.outWeights[i];
+
+    return output / OUTPUT_SCALE;
+}
+
+// The position at the stack's current ply, which must be board
+inline int Evaluate( AccumulatorStack &stack, const Board &board ) {
+    return Evaluate( stack.Update( board.bitboards ), board.whiteToMove );
+}
+
+// A position outside any search: the accumulator is built from scratch
+inline int Evaluate( const Board &board ) {
+    Accumulator acc;
+    Refresh( acc, WHITE_SIDE, board.bitboards );
+    Refresh( acc, BLACK_SIDE, board.bitboards );
+    return Evaluate( acc, board.whiteToMove );
+}
+
+} // namespace NNUE
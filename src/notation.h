@@ -0,0 +1,353 @@
+#pragma once
+
+#include "board.h"
+#include "game_state.h"
+#include "attacks.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// Move Notation
+// ============================================================================
+// Text forms of moves for engine protocols and game records. UCI long
+// algebraic is the from and to square plus a lowercase promotion letter
+// (e2e4, e7e8q); castling is written as the king's two-square move (e1g1).
+
+inline std::string SquareName( int square ) {
+    return { static_cast<char>( 'a' + FileOf( square ) ), static_cast<char>( '1' + RankOf( square ) ) };
+}
+
+// Square at text[pos], or -1 when it isn't one
+inline int ParseSquare( const std::string &text, size_t pos ) {
+    if ( pos + 2 > text.size() )
+        return -1;
+    int file = text[pos] - 'a';
+    int rank = text[pos + 1] - '1';
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8 ? MakeSquare( rank, file ) : -1;
+}
+
+inline std::string ToUci( const Move &move ) {
+    std::string text = SquareName( move.fromSquare ) + SquareName( move.toSquare );
+    if ( move.isPromotion )
+        text += static_cast<char>( PIECE_CHARS[move.promotedPiece % 6 + 6] ); // Lowercase letter
+    return text;
+}
+
+// The legal move written as text, if there is one
+inline bool ParseUci( Board &board, const std::string &text, Move &move ) {
+    int from = ParseSquare( text, 0 );
+    int to = ParseSquare( text, 2 );
+    if ( from < 0 || to < 0 )
+        return false;
+    char promotion = text.size() > 4 ? static_cast<char>( tolower( text[4] ) ) : 0;
+
+    std::vector<Move> legal;
+    GameState::GenerateAllLegalMoves( board, legal, board.whiteToMove );
+    for ( const Move &candidate : legal ) {
+        if ( candidate.fromSquare != from || candidate.toSquare != to )
+            continue;
+        if ( candidate.isPromotion && PIECE_CHARS[candidate.promotedPiece % 6 + 6] != promotion )
+            continue;
+        move = candidate;
+        return true;
+    }
+    return false;
+}
+
+// UCI score text ("cp 35", "mate -2") for a side-to-move score. Mate scores
+// carry no distance, so mate is reported only when the pv from board plays
+// out to the mate and its length gives the distance; a pv cut short by a
+// transposition table cutoff reports the score in centipawns instead.
+inline std::string UciScore( Board board, int score, const std::vector<Move> &pv ) {
+    for ( Move move : pv )
+        board.MakeMove( move );
+    if ( !GameState::IsCheckmate( board, board.whiteToMove ) )
+        return "cp " + std::to_string( score );
+    int moves = ( static_cast<int>( pv.size() ) + 1 ) / 2;
+    return "mate " + std::to_string( score > 0 ? moves : -moves );
+}
+
+// ============================================================================
+// Standard Algebraic Notation
+// ============================================================================
+// SAN as in PGN: Nf3, exd5, O-O, e8=Q+, Qxf7#. Piece moves are
+// disambiguated by file, then rank, then both, against the other legal
+// moves. board is the position before the move and is left unchanged.
+//
+// Both directions work from attack bitboards instead of the full legal move
+// list: only the handful of pieces that reach the target square are tried
+// for legality, and replies are generated only to tell mate from check.
+// PGN reading and writing run through here at millions of moves a second.
+
+// Squares a piece of the given type (white index) on square attacks
+inline uint64_t PieceAttacksFrom( int type, int square, uint64_t occupied ) {
+    switch ( type ) {
+    case WN:
+        return Attacks::knightAttacks[square];
+    case WB:
+        return Attacks::GetBishopAttacks( square, occupied );
+    case WR:
+        return Attacks::GetRookAttacks( square, occupied );
+    case WQ:
+        return Attacks::GetQueenAttacks( square, occupied );
+    case WK:
+        return Attacks::kingAttacks[square];
+    default:
+        return 0;
+    }
+}
+
+// Whether the side to move has any legal move; stops at the first
+inline bool HasLegalMove( Board &board ) {
+    thread_local std::vector<Move> moves;
+    moves.clear();
+    MoveGen::GenerateAllPseudoLegal( board, moves, board.whiteToMove );
+    for ( Move &move : moves ) {
+        if ( GameState::IsMoveLegal( board, move, board.whiteToMove ) )
+            return true;
+    }
+    return false;
+}
+
+inline void AppendSan( Board &board, const Move &move, std::string &san ) {
+    int piece = board.mailbox[move.fromSquare] % 6;
+
+    if ( move.isCastling ) {
+        san += FileOf( move.toSquare ) == 6 ? "O-O" : "O-O-O";
+    } else if ( piece == WP ) {
+        if ( move.isCapture ) {
+            san += static_cast<char>( 'a' + FileOf( move.fromSquare ) );
+            san += 'x';
+        }
+        san += SquareName( move.toSquare );
+        if ( move.isPromotion ) {
+            san += '=';
+            san += PIECE_CHARS[move.promotedPiece % 6];
+        }
+    } else {
+        san += PIECE_CHARS[piece];
+
+        // Other pieces of the same kind that can legally reach the square
+        uint64_t others = PieceAttacksFrom( piece, move.toSquare, board.occupancies[2] ) &
+                          board.bitboards[board.mailbox[move.fromSquare]] & ~( 1ULL << move.fromSquare );
+        bool ambiguous = false, sameFile = false, sameRank = false;
+        while ( others ) {
+            Move other( PopLSB( others ), move.toSquare, move.isCapture );
+            if ( !GameState::IsMoveLegal( board, other, board.whiteToMove ) )
+                continue;
+            ambiguous = true;
+            sameFile |= FileOf( other.fromSquare ) == FileOf( move.fromSquare );
+            sameRank |= RankOf( other.fromSquare ) == RankOf( move.fromSquare );
+        }
+        if ( ambiguous && ( !sameFile || sameRank ) )
+            san += static_cast<char>( 'a' + FileOf( move.fromSquare ) );
+        if ( ambiguous && sameFile )
+            san += static_cast<char>( '1' + RankOf( move.fromSquare ) );
+
+        if ( move.isCapture )
+            san += 'x';
+        san += SquareName( move.toSquare );
+    }
+
+    // Check or mate, from the position after the move
+    Move played = move;
+    board.MakeMove( played );
+    if ( GameState::IsKingInCheck( board, board.whiteToMove ) )
+        san += HasLegalMove( board ) ? '+' : '#';
+    board.UndoMove( played );
+}
+
+inline std::string ToSan( Board &board, const Move &move ) {
+    std::string san;
+    AppendSan( board, move, san );
+    return san;
+}
+
+// The legal move written as SAN, if there is exactly one. Check and
+// annotation marks are ignored, '=' before a promotion is optional and
+// "0-0" reads as "O-O". No string is copied.
+inline bool ResolveSan( Board &board, std::string_view text, Move &move ) {
+    while ( !text.empty() && ( text.back() == '+' || text.back() == '#' || text.back() == '!' || text.back() == '?' ) )
+        text.remove_suffix( 1 );
+    bool white = board.whiteToMove;
+    int us = white ? WHITE_SIDE : BLACK_SIDE;
+    int base = white ? WP : BP; // Piece index of our pawn
+    uint64_t occupied = board.occupancies[2];
+
+    if ( text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0" ) {
+        uint64_t king = board.bitboards[base + WK];
+        if ( !king )
+            return false;
+        int from = BitScanForward( king );
+        int to = text.size() == 3 ? from + 2 : from - 2;
+
+        // The generator checks the rights, the empty path and the attacked squares
+        thread_local std::vector<Move> kingMoves;
+        kingMoves.clear();
+        if ( white )
+            MoveGen::GenerateKingMoves<true>( board, kingMoves );
+        else
+            MoveGen::GenerateKingMoves<false>( board, kingMoves );
+        for ( Move &candidate : kingMoves ) {
+            if ( !candidate.isCastling || candidate.toSquare != to )
+                continue;
+            move = candidate;
+            return GameState::IsMoveLegal( board, candidate, white );
+        }
+        return false;
+    }
+
+    int type = WP;
+    if ( !text.empty() && text[0] >= 'B' && text[0] <= 'R' ) {
+        int piece = PieceFromChar( text[0] );
+        if ( piece == NO_PIECE || piece == WP )
+            return false;
+        type = piece;
+        text.remove_prefix( 1 );
+    }
+
+    // Promotion letter, then the target square
+    int promotion = -1;
+    if ( type == WP && !text.empty() && isalpha( static_cast<unsigned char>( text.back() ) ) ) {
+        int piece = PieceFromChar( static_cast<char>( toupper( text.back() ) ) );
+        if ( piece < WN || piece > WQ )
+            return false;
+        promotion = base + piece;
+        text.remove_suffix( 1 );
+        if ( !text.empty() && text.back() == '=' )
+            text.remove_suffix( 1 );
+    }
+    if ( text.size() < 2 )
+        return false;
+    int toFile = text[text.size() - 2] - 'a', toRank = text[text.size() - 1] - '1';
+    if ( toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7 )
+        return false;
+    int to = MakeSquare( toRank, toFile );
+    text.remove_suffix( 2 );
+
+    // Whatever is left disambiguates: a file, a rank, 'x', or '-' as in Ng1-f3
+    int fromFile = -1, fromRank = -1;
+    for ( char c : text ) {
+        if ( c >= 'a' && c <= 'h' )
+            fromFile = c - 'a';
+        else if ( c >= '1' && c <= '8' )
+            fromRank = c - '1';
+        else if ( c != 'x' && c != '-' )
+            return false;
+    }
+
+    uint64_t target = 1ULL << to;
+    if ( board.occupancies[us] & target )
+        return false;
+    bool capture = board.occupancies[us ^ 1] & target;
+
+    uint64_t candidates;
+    if ( type == WP ) {
+        int up = white ? 8 : -8;
+        bool lastRank = toRank == ( white ? 7 : 0 );
+        if ( lastRank != ( promotion >= 0 ) )
+            return false;
+        if ( capture ) {
+            if ( fromFile < 0 || std::abs( fromFile - toFile ) != 1 )
+                return false;
+            candidates = 1ULL << ( to - up + fromFile - toFile );
+        } else {
+            if ( fromFile >= 0 && fromFile != toFile )
+                return false; // Would be en passant, which the engine does not play
+            candidates = 1ULL << ( to - up );
+            if ( !( board.bitboards[base] & candidates ) && toRank == ( white ? 3 : 4 ) && !( occupied & candidates ) )
+                candidates = 1ULL << ( to - 2 * up );
+        }
+    } else {
+        candidates = PieceAttacksFrom( type, to, occupied );
+    }
+    candidates &= board.bitboards[base + type];
+    if ( fromFile >= 0 && type != WP )
+        candidates &= Attacks::fileMask[fromFile];
+    if ( fromRank >= 0 )
+        candidates &= RANK_1 << ( 8 * fromRank );
+
+    int found = 0;
+    while ( candidates ) {
+        Move candidate( PopLSB( candidates ), to, capture, false, false, promotion >= 0, promotion );
+        if ( GameState::IsMoveLegal( board, candidate, white ) ) {
+            move = candidate;
+            found++;
+        }
+    }
+    return found == 1;
+}
+
+// SAN, or failing that UCI text
+inline bool ParseSan( Board &board, std::string_view text, Move &move ) {
+    return ResolveSan( board, text, move ) || ParseUci( board, std::string( text ), move );
+}
+
+// ============================================================================
+// Checked FEN
+// ============================================================================
+// LoadFEN trusts its input. Text from outside the engine goes through here
+// first: the placement must be eight ranks of eight files with one king a
+// side and no pawn on the first or last rank, the side to move w or b, and
+// the side not to move not in check. Castling rights are kept only where
+// the king and that rook stand on their home squares; the en passant field
+// and the move counters are ignored, as LoadFEN ignores them.
+
+inline bool LoadCheckedFen( Board &board, const std::string &fen ) {
+    size_t end = fen.find( ' ' );
+    if ( end == std::string::npos )
+        return false;
+
+    char squares[64] = {};
+    int rank = 7, file = 0;
+    for ( size_t i = 0; i < end; i++ ) {
+        char c = fen[i];
+        if ( c == '/' ) {
+            if ( file != 8 || rank == 0 )
+                return false;
+            rank--;
+            file = 0;
+        } else if ( c >= '1' && c <= '8' ) {
+            file += c - '0';
+            if ( file > 8 )
+                return false;
+        } else {
+            int piece = PieceFromChar( c );
+            if ( piece == NO_PIECE || file == 8 || ( piece % 6 == WP && ( rank == 0 || rank == 7 ) ) )
+                return false;
+            squares[MakeSquare( rank, file++ )] = c;
+        }
+    }
+    if ( rank != 0 || file != 8 || std::count( squares, squares + 64, 'K' ) != 1 ||
+         std::count( squares, squares + 64, 'k' ) != 1 )
+        return false;
+
+    std::istringstream fields( fen.substr( end ) );
+    std::string side, castling;
+    fields >> side >> castling;
+    if ( side != "w" && side != "b" )
+        return false;
+    if ( castling.empty() )
+        castling = "-";
+    if ( castling != "-" && castling.find_first_not_of( "KQkq" ) != std::string::npos )
+        return false;
+
+    std::string rights;
+    for ( char right : castling ) {
+        bool white = right == 'K' || right == 'Q';
+        bool kingside = right == 'K' || right == 'k';
+        int king = white ? E1 : E8;
+        int rook = kingside ? ( white ? H1 : H8 ) : ( white ? A1 : A8 );
+        if ( right != '-' && squares[king] == ( white ? 'K' : 'k' ) && squares[rook] == ( white ? 'R' : 'r' ) )
+            rights += right;
+    }
+
+    board = Board();
+    board.LoadFEN( fen.substr( 0, end ) + " " + side + " " + ( rights.empty() ? "-" : rights ) );
+    return !GameState::IsKingInCheck( board, !board.whiteToMove );
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// ============================================================================
+// Pawn Hash Table
+// ============================================================================
+// Caches the pawn-structure score and the bitboards derived from the pawns,
+// keyed by Board::pawnKey. Pawn structure changes in only a small fraction
+// of moves, so most evaluations hit. Each thread owns its own table (see
+// Evaluator::PawnTable), so no locking is needed.
+
+#include "score.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+struct PawnEntry {
+    uint64_t key = ~0ULL;         // Never a real key in practice, so fresh slots miss
+    Score score = SCORE_ZERO;     // Doubled, isolated and passed pawns (white-relative)
+    uint64_t passedPawns[2] = {}; // [color] passed pawns
+    uint64_t attackSpans[2] = {}; // [color] squares the pawns attack or can attack by advancing
+    uint8_t openFiles[2] = {};    // [color] bit per file without a pawn of that color
+};
+
+class PawnHashTable {
+  public:
+    static constexpr size_t DEFAULT_ENTRIES = 1 << 13; // Must be a power of two
+
+    explicit PawnHashTable( size_t entries = DEFAULT_ENTRIES ) : table( entries ), mask( entries - 1 ) {}
+
+    // Slot for a key; the caller checks entry.key and fills the slot on a miss
+    PawnEntry &Probe( uint64_t key ) {
+        probes++;
+        PawnEntry &entry = table[key & mask];
+        if ( entry.key == key )
+            hits++;
+        return entry;
+    }
+
+    void Clear() {
+        std::fill( table.begin(), table.end(), PawnEntry() );
+        probes = hits = 0;
+    }
+
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+  private:
+    std::vector<PawnEntry> table;
+    size_t mask;
+};
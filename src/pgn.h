@@ -0,0 +1,426 @@
+#pragma once
+
+#include "board.h"
+#include "notation.h"
+#include <algorithm>
+#include <cctype>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// PGN Games
+// ============================================================================
+// Streaming reader and writer for PGN collections. The reader walks one
+// contiguous buffer, normally a memory-mapped file: games, tag pairs and
+// movetext tokens are string_views into it, so nothing is copied per game
+// or per move. Moves are resolved with ResolveSan (notation.h) and played
+// on a Board. The engine has no en passant, so a game that plays one stops
+// replaying at that move. Games are told apart by their tag pairs: movetext
+// runs until the next line that opens a tag.
+//
+// ParallelForEach splits a buffer at game boundaries and reads the pieces
+// on separate threads; a boundary is a tag line that follows a non-tag
+// line, so a '[' opening a line inside a multi-line comment could split a
+// game in two.
+
+namespace Pgn {
+
+// ============================================================================
+// Input
+// ============================================================================
+
+// A read-only mapping of a whole file
+class MappedFile {
+  public:
+    MappedFile() = default;
+    MappedFile( const MappedFile & ) = delete;
+    MappedFile &operator=( const MappedFile & ) = delete;
+    ~MappedFile() { Close(); }
+
+    bool Open( const std::string &path ) {
+        Close();
+        int fd = open( path.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            return false;
+        struct stat info;
+        bool ok = fstat( fd, &info ) == 0;
+        if ( ok && info.st_size > 0 ) {
+            void *mapped = mmap( nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            ok = mapped != MAP_FAILED;
+            if ( ok ) {
+                madvise( mapped, info.st_size, MADV_SEQUENTIAL );
+                data = static_cast<const char *>( mapped );
+                size = static_cast<size_t>( info.st_size );
+            }
+        }
+        close( fd );
+        return ok; // An empty file is an empty collection
+    }
+
+    void Close() {
+        if ( data )
+            munmap( const_cast<char *>( data ), size );
+        data = nullptr;
+        size = 0;
+    }
+
+    std::string_view Text() const { return { data, size }; }
+
+  private:
+    const char *data = nullptr;
+    size_t size = 0;
+};
+
+struct Tag {
+    std::string_view name;
+    std::string_view value; // As written, escapes included
+};
+
+struct GameText {
+    std::vector<Tag> tags;
+    std::string_view movetext;
+
+    std::string_view TagValue( std::string_view name ) const {
+        for ( const Tag &tag : tags ) {
+            if ( tag.name == name )
+                return tag.value;
+        }
+        return {};
+    }
+};
+
+inline bool IsResult( std::string_view token ) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+inline bool IsSpace( char c ) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+// Games one after another: the tag pairs, then the movetext up to the next
+// line that starts with '[' outside a comment
+class Reader {
+  public:
+    explicit Reader( std::string_view text ) : text( text ) {}
+
+    bool Next( GameText &game ) {
+        game.tags.clear();
+        SkipSpace();
+        while ( pos < text.size() && text[pos] == '[' ) {
+            ReadTag( game );
+            SkipSpace();
+        }
+
+        size_t start = pos;
+        bool inComment = false;
+        for ( ; pos < text.size(); pos++ ) {
+            char c = text[pos];
+            if ( inComment ) {
+                inComment = c != '}';
+            } else if ( c == '{' ) {
+                inComment = true;
+            } else if ( c == '\n' && pos + 1 < text.size() && text[pos + 1] == '[' ) {
+                pos++;
+                break;
+            }
+        }
+        game.movetext = text.substr( start, pos - start );
+        return !game.tags.empty() || !game.movetext.empty();
+    }
+
+    size_t Offset() const { return pos; }
+
+  private:
+    std::string_view text;
+    size_t pos = 0;
+
+    void SkipSpace() {
+        while ( pos < text.size() && IsSpace( text[pos] ) )
+            pos++;
+    }
+
+    // [Name "value"]; a malformed line is skipped whole
+    void ReadTag( GameText &game ) {
+        size_t lineEnd = text.find( '\n', pos );
+        if ( lineEnd == std::string_view::npos )
+            lineEnd = text.size();
+        size_t nameStart = pos + 1, nameEnd = nameStart;
+        while ( nameEnd < lineEnd && !IsSpace( text[nameEnd] ) && text[nameEnd] != '"' )
+            nameEnd++;
+        size_t open = text.find( '"', nameEnd );
+        size_t close = open;
+        while ( close != std::string_view::npos && close < lineEnd ) {
+            close = text.find( '"', close + 1 );
+            if ( close == std::string_view::npos || text[close - 1] != '\\' )
+                break;
+        }
+        if ( open < lineEnd && close != std::string_view::npos && close < lineEnd )
+            game.tags.push_back( { text.substr( nameStart, nameEnd - nameStart ),
+                                   text.substr( open + 1, close - open - 1 ) } );
+        pos = lineEnd;
+    }
+};
+
+// The SAN moves of a movetext, skipping move numbers, comments, variations
+// and NAGs; the result token ends the moves
+class MoveTokens {
+  public:
+    explicit MoveTokens( std::string_view movetext ) : text( movetext ) {}
+
+    bool Next( std::string_view &san ) {
+        while ( pos < text.size() ) {
+            char c = text[pos];
+            if ( IsSpace( c ) || c == '.' || c == ')' ) {
+                pos++;
+            } else if ( c == '{' ) {
+                pos = Skip( text.find( '}', pos ) );
+            } else if ( c == ';' ) {
+                pos = Skip( text.find( '\n', pos ) );
+            } else if ( c == '(' ) {
+                SkipVariation();
+            } else {
+                size_t start = pos;
+                while ( pos < text.size() && !IsSpace( text[pos] ) && text[pos] != '{' && text[pos] != '(' &&
+                        text[pos] != ';' && text[pos] != ')' && !( text[pos] == '.' && IsNumber( start ) ) )
+                    pos++;
+                std::string_view token = text.substr( start, pos - start );
+                if ( IsResult( token ) ) {
+                    result = token;
+                    pos = text.size();
+                    return false;
+                }
+                if ( c == '$' || ( isdigit( static_cast<unsigned char>( c ) ) && !IsZeroCastling( token ) ) )
+                    continue; // NAG or move number
+                san = token;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view Result() const { return result; }
+
+  private:
+    std::string_view text;
+    std::string_view result;
+    size_t pos = 0;
+
+    size_t Skip( size_t end ) const { return end == std::string_view::npos ? text.size() : end + 1; }
+
+    // 0-0 or 0-0-0, castling written with zeros, which starts with a digit
+    // like a move number; check and annotation marks may follow
+    static bool IsZeroCastling( std::string_view token ) {
+        while ( !token.empty() && ( token.back() == '+' || token.back() == '#' || token.back() == '!' ||
+                                    token.back() == '?' ) )
+            token.remove_suffix( 1 );
+        return token == "0-0" || token == "0-0-0";
+    }
+
+    // Digits from start to pos: a move number about to meet its dots
+    bool IsNumber( size_t start ) const {
+        for ( size_t i = start; i < pos; i++ ) {
+            if ( !isdigit( static_cast<unsigned char>( text[i] ) ) )
+                return false;
+        }
+        return true;
+    }
+
+    void SkipVariation() {
+        int depth = 0;
+        for ( ; pos < text.size(); pos++ ) {
+            char c = text[pos];
+            if ( c == '{' ) {
+                pos = Skip( text.find( '}', pos ) ) - 1;
+            } else if ( c == '(' ) {
+                depth++;
+            } else if ( c == ')' && --depth == 0 ) {
+                pos++;
+                return;
+            }
+        }
+    }
+};
+
+struct Replayed {
+    int plies = 0;
+    bool complete = false; // Every move was read; false if one was illegal or unreadable
+    std::string_view result;
+    std::string_view badMove; // The move that stopped the replay
+    std::string_view badFen;  // The FEN tag LoadCheckedFen rejected; board is left empty
+};
+
+// Sets board to the game's start (the FEN tag, or the initial position)
+// and plays its moves; onMove( board, move ) sees each move before it is
+// made and returns false to stop early. A FEN tag comes from the file, so
+// it goes through LoadCheckedFen; one it rejects stops the replay at once.
+template <typename OnMove> inline Replayed Replay( const GameText &game, Board &board, OnMove &&onMove ) {
+    Replayed replayed;
+    board = Board();
+    std::string_view fen = game.TagValue( "FEN" );
+    if ( fen.empty() ) {
+        board.Reset();
+    } else if ( !LoadCheckedFen( board, std::string( fen ) ) ) {
+        board = Board();
+        replayed.badFen = fen;
+        return replayed;
+    }
+
+    MoveTokens tokens( game.movetext );
+    std::string_view san;
+    while ( tokens.Next( san ) ) {
+        Move move( 0, 0 );
+        if ( !ResolveSan( board, san, move ) ) {
+            replayed.badMove = san;
+            return replayed;
+        }
+        if ( !onMove( static_cast<const Board &>( board ), static_cast<const Move &>( move ) ) )
+            return replayed;
+        board.MakeMove( move );
+        replayed.plies++;
+    }
+    replayed.complete = true;
+    replayed.result = tokens.Result();
+    return replayed;
+}
+
+// Start offsets of about parts pieces of text, each beginning at a game
+inline std::vector<size_t> SplitGames( std::string_view text, int parts ) {
+    std::vector<size_t> starts{ 0 };
+    for ( int i = 1; i < parts; i++ ) {
+        size_t pos = std::max( starts.back(), text.size() * i / parts );
+        pos = text.find( '\n', pos );
+        bool previousIsTag = true; // Unknown before the first whole line, so never split there
+        while ( pos != std::string_view::npos && pos + 1 < text.size() ) {
+            size_t lineStart = pos + 1;
+            size_t lineEnd = text.find( '\n', lineStart );
+            if ( lineEnd == std::string_view::npos )
+                lineEnd = text.size();
+            size_t first = lineStart;
+            while ( first < lineEnd && IsSpace( text[first] ) )
+                first++;
+            if ( first < lineEnd ) {
+                bool isTag = text[first] == '[';
+                if ( isTag && !previousIsTag )
+                    break;
+                previousIsTag = isTag;
+            }
+            pos = lineEnd;
+        }
+        if ( pos == std::string_view::npos || pos + 1 >= text.size() )
+            break;
+        starts.push_back( pos + 1 );
+    }
+    return starts;
+}
+
+// Reads the games of text on threads threads; perGame( thread, game ) is
+// called on the reading thread. Games are seen in order within a piece.
+template <typename PerGame> inline void ParallelForEach( std::string_view text, int threads, PerGame &&perGame ) {
+    std::vector<size_t> starts = SplitGames( text, threads );
+    std::vector<std::thread> workers;
+    for ( size_t i = 0; i < starts.size(); i++ ) {
+        size_t end = i + 1 < starts.size() ? starts[i + 1] : text.size();
+        workers.emplace_back( [&perGame, piece = text.substr( starts[i], end - starts[i] ), i] {
+            Reader reader( piece );
+            GameText game;
+            while ( reader.Next( game ) )
+                perGame( static_cast<int>( i ), game );
+        } );
+    }
+    for ( auto &worker : workers )
+        worker.join();
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+// Movetext in lines of at most 80 columns, each move number on its move's
+// line: 1. e4 e5 2. Nf3, or 7... Qd8 when black moves first
+class MovetextWriter {
+  public:
+    MovetextWriter( std::string &out, int moveNumber = 1, bool whiteToMove = true )
+        : out( out ), moveNumber( moveNumber ), whiteToMove( whiteToMove ) {}
+
+    // The move's SAN in board, the position before it; board is unchanged
+    void Add( Board &board, const Move &move ) {
+        san.clear();
+        AppendSan( board, move, san );
+        AddSan( san );
+    }
+
+    void AddSan( std::string_view text ) {
+        std::string &token = scratch;
+        token.clear();
+        if ( whiteToMove || first ) {
+            token += std::to_string( moveNumber );
+            token += whiteToMove ? ". " : "... ";
+        }
+        token += text;
+        Token( token );
+        first = false;
+        if ( !whiteToMove )
+            moveNumber++;
+        whiteToMove = !whiteToMove;
+    }
+
+    // A comment, a result or anything else kept whole on one line
+    void Token( std::string_view token ) {
+        if ( lineLength > 0 && lineLength + 1 + token.size() > 80 ) {
+            out += '\n';
+            lineLength = 0;
+        }
+        if ( lineLength > 0 ) {
+            out += ' ';
+            lineLength++;
+        }
+        out += token;
+        lineLength += token.size();
+    }
+
+    void Finish() {
+        out += '\n';
+        lineLength = 0;
+    }
+
+  private:
+    std::string &out;
+    std::string san, scratch;
+    int moveNumber;
+    bool whiteToMove;
+    bool first = true;
+    size_t lineLength = 0;
+};
+
+// A whole game: tag pairs in order, the moves from start, the result and a
+// blank line
+inline void AppendGame( std::string &out, const std::vector<std::pair<std::string, std::string>> &tags,
+                        const Board &start, const std::vector<Move> &moves, std::string_view result,
+                        int firstMoveNumber = 1 ) {
+    for ( const auto &[name, value] : tags ) {
+        out += '[';
+        out += name;
+        out += " \"";
+        out += value;
+        out += "\"]\n";
+    }
+    out += '\n';
+
+    Board board = start;
+    MovetextWriter writer( out, firstMoveNumber, board.whiteToMove );
+    for ( const Move &move : moves ) {
+        writer.Add( board, move );
+        Move played = move;
+        board.MakeMove( played );
+    }
+    writer.Token( result );
+    writer.Finish();
+    out += '\n';
+}
+
+} // namespace Pgn
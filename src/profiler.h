@@ -0,0 +1,83 @@
+#pragma once
+
+// ============================================================================
+// Scoped Timers
+// ============================================================================
+// PROFILE_SCOPE( seconds ) adds the time from that line to the end of the
+// enclosing scope to a double. Building with -DCHESS_NO_PROFILE compiles
+// every timer out and the accumulators simply stay at zero.
+//
+// A timer costs two steady_clock reads, so it belongs around work of a
+// microsecond or more: a frame phase, a move generation, an evaluation.
+
+#include <algorithm>
+#include <chrono>
+
+namespace Profiler {
+
+using Clock = std::chrono::steady_clock;
+
+class ScopedTimer {
+  public:
+    explicit ScopedTimer( double &seconds ) : seconds( seconds ), start( Clock::now() ) {}
+    ~ScopedTimer() { seconds += std::chrono::duration<double>( Clock::now() - start ).count(); }
+
+    ScopedTimer( const ScopedTimer & ) = delete;
+    ScopedTimer &operator=( const ScopedTimer & ) = delete;
+
+  private:
+    double &seconds;
+    Clock::time_point start;
+};
+
+// The last N samples, oldest first, for rolling averages, percentiles and graphs
+template <int N> class History {
+  public:
+    static constexpr int CAPACITY = N;
+
+    void Push( float sample ) {
+        samples[next] = sample;
+        next = ( next + 1 ) % N;
+        count = std::min( count + 1, N );
+    }
+
+    int Size() const { return count; }
+
+    // i = 0 is the oldest sample kept
+    float At( int i ) const { return samples[( next - count + i + N ) % N]; }
+
+    float Mean() const {
+        float sum = 0;
+        for ( int i = 0; i < count; i++ )
+            sum += samples[i];
+        return count ? sum / count : 0;
+    }
+
+    float Max() const { return count ? *std::max_element( samples, samples + count ) : 0; }
+
+    // p in [0, 1]; nearest-rank on a sorted copy
+    float Percentile( float p ) const {
+        if ( count == 0 )
+            return 0;
+        float sorted[N];
+        std::copy( samples, samples + count, sorted );
+        int rank = std::min( count - 1, static_cast<int>( p * count ) );
+        std::nth_element( sorted, sorted + rank, sorted + count );
+        return sorted[rank];
+    }
+
+  private:
+    float samples[N] = {};
+    int next = 0;
+    int count = 0;
+};
+
+} // namespace Profiler
+
+#if defined( CHESS_NO_PROFILE )
+#define PROFILE_SCOPE( seconds )
+#else
+#define PROFILE_CONCAT_INNER( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_INNER( a, b )
+#define PROFILE_SCOPE( seconds ) Profiler::ScopedTimer PROFILE_CONCAT( profileTimer, __LINE__ )( seconds )
+#endif
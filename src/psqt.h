@@ -0,0 +1,126 @@
+#pragma once
+
+// ============================================================================
+// Piece Values and Piece-Square Tables
+// ============================================================================
+// Shared by the Board (incremental accumulators) and the Evaluator.
+// The tables are laid out as seen from white with a8 first, so white pieces
+// index them via FlipSquare and black pieces directly.
+
+#include "bitboard.h"
+#include "score.h"
+
+namespace PSQT {
+
+// Piece values (centipawns)
+constexpr int PIECE_VALUES[6] = {
+    100, // Pawn
+    320, // Knight (slightly higher than bishop)
+    330, // Bishop (slightly higher than knight)
+    500, // Rook
+    900, // Queen
+    0    // King (not actually used in material eval)
+};
+
+// Game phase weight per piece type (MAX_PHASE = full set of minor and major pieces)
+constexpr int PHASE_WEIGHTS[6] = { 0, 1, 1, 2, 4, 0 };
+
+// Material signature radix per piece: a side's counts of P (0-8), N, B, R
+// (0-2 each) and Q (0-1) form one mixed-radix number, black's shifted above
+// white's. See material.h for the table it indexes.
+constexpr uint32_t MATERIAL_SIDE_SPAN = 9 * 3 * 3 * 3 * 2;
+constexpr uint32_t MATERIAL_KEY_WEIGHTS[12] = { 1,
+                                                9,
+                                                27,
+                                                81,
+                                                243,
+                                                0, // White P N B R Q K
+                                                1 * MATERIAL_SIDE_SPAN,
+                                                9 * MATERIAL_SIDE_SPAN,
+                                                27 * MATERIAL_SIDE_SPAN,
+                                                81 * MATERIAL_SIDE_SPAN,
+                                                243 * MATERIAL_SIDE_SPAN,
+                                                0 }; // Black P N B R Q K
+
+// Term weights in percent {middlegame, endgame}
+constexpr int MATERIAL_WEIGHT[2] = { 80, 120 };
+constexpr int PSQT_WEIGHT[2] = { 30, 36 };
+
+// Piece-square tables (middlegame)
+constexpr int PAWN_TABLE[64] = { 0,  0,  0,  0,   0,   0,  0,  0,  50, 50, 50,  50, 50, 50,  50, 50,
+                                 10, 10, 20, 30,  30,  20, 10, 10, 5,  5,  10,  25, 25, 10,  5,  5,
+                                 0,  0,  0,  20,  20,  0,  0,  0,  5,  -5, -10, 0,  0,  -10, -5, 5,
+                                 5,  10, 10, -20, -20, 10, 10, 5,  0,  0,  0,   0,  0,  0,   0,  0 };
+
+constexpr int KNIGHT_TABLE[64] = { -50, -40, -30, -30, -30, -30, -40, -50, -40, -20, 0,   0,   0,
+                                   0,   -20, -40, -30, 0,   10,  15,  15,  10,  0,   -30, -30, 5,
+                                   15,  20,  20,  15,  5,   -30, -30, 0,   15,  20,  20,  15,  0,
+                                   -30, -30, 5,   10,  15,  15,  10,  5,   -30, -40, -20, 0,   5,
+                                   5,   0,   -20, -40, -50, -40, -30, -30, -30, -30, -40, -50 };
+
+constexpr int BISHOP_TABLE[64] = { -20, -10, -10, -10, -10, -10, -10, -20, -10, 0,   0,   0,   0,
+                                   0,   0,   -10, -10, 0,   5,   10,  10,  5,   0,   -10, -10, 5,
+                                   5,   10,  10,  5,   5,   -10, -10, 0,   10,  10,  10,  10,  0,
+                                   -10, -10, 10,  10,  10,  10,  10,  10,  -10, -10, 5,   0,   0,
+                                   0,   0,   5,   -10, -20, -10, -10, -10, -10, -10, -10, -20 };
+
+constexpr int ROOK_TABLE[64] = { 0,  0, 0, 0, 0, 0, 0, 0,  5,  10, 10, 10, 10, 10, 10, 5,
+                                 -5, 0, 0, 0, 0, 0, 0, -5, -5, 0,  0,  0,  0,  0,  0,  -5,
+                                 -5, 0, 0, 0, 0, 0, 0, -5, -5, 0,  0,  0,  0,  0,  0,  -5,
+                                 -5, 0, 0, 0, 0, 0, 0, -5, 0,  0,  0,  5,  5,  0,  0,  0 };
+
+constexpr int QUEEN_TABLE[64] = { -20, -10, -10, -5,  -5,  -10, -10, -20, -10, 0,  0, 0,   0,   0,   0,   -10,
+                                  -10, 0,   5,   5,   5,   5,   0,   -10, -5,  0,  5, 5,   5,   5,   0,   -5,
+                                  0,   0,   5,   5,   5,   5,   0,   -5,  -10, 5,  5, 5,   5,   5,   0,   -10,
+                                  -10, 0,   5,   0,   0,   0,   0,   -10, -20, -10, -10, -5, -5, -10, -10, -20 };
+
+constexpr int KING_MIDDLE_GAME[64] = { -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50,
+                                       -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30, -30, -40,
+                                       -40, -50, -50, -40, -40, -30, -20, -30, -30, -40, -40, -30, -30,
+                                       -20, -10, -20, -20, -20, -20, -20, -20, -10, 20,  20,  0,   0,
+                                       0,   0,   20,  20,  20,  30,  10,  0,   0,   10,  30,  20 };
+
+constexpr int KING_END_GAME[64] = { -50, -40, -30, -20, -20, -30, -40, -50, -30, -20, -10, 0,   0,
+                                    -10, -20, -30, -30, -10, 20,  30,  30,  20,  -10, -30, -30, -10,
+                                    30,  40,  40,  30,  -10, -30, -30, -10, 30,  40,  40,  30,  -10,
+                                    -30, -30, -10, 20,  30,  30,  20,  -10, -30, -30, -30, 0,   0,
+                                    0,   0,   -30, -30, -50, -30, -30, -30, -30, -30, -30, -50 };
+
+// Flip square index between white's and black's point of view
+inline constexpr int FlipSquare( int square ) {
+    return square ^ 56; // Flips rank
+}
+
+// ============================================================================
+// Packed Lookup Tables
+// ============================================================================
+// Indexed by board piece (WP..BK) and square, already weighted. Values are
+// white-relative, so black entries are negated and the accumulators are sums.
+
+struct PackedTables {
+    Score material[12];
+    Score psqt[12][64];
+};
+
+inline constexpr PackedTables BuildPackedTables() {
+    PackedTables t{};
+    const int *tables[6] = { PAWN_TABLE, KNIGHT_TABLE, BISHOP_TABLE, ROOK_TABLE, QUEEN_TABLE, KING_MIDDLE_GAME };
+
+    for ( int piece = 0; piece < 12; piece++ ) {
+        int type = piece % 6;
+        int sign = piece < 6 ? 1 : -1;
+        t.material[piece] = sign * WeightedScore( PIECE_VALUES[type], PIECE_VALUES[type], MATERIAL_WEIGHT );
+
+        for ( int sq = 0; sq < 64; sq++ ) {
+            int evalSquare = piece < 6 ? FlipSquare( sq ) : sq;
+            int mg = tables[type][evalSquare];
+            int eg = type == 5 ? KING_END_GAME[evalSquare] : mg;
+            t.psqt[piece][sq] = sign * WeightedScore( mg, eg, PSQT_WEIGHT );
+        }
+    }
+    return t;
+}
+
+inline constexpr PackedTables PACKED = BuildPackedTables();
+
+} // namespace PSQT
@@ -0,0 +1,72 @@
+#pragma once
+
+// ============================================================================
+// Packed Middlegame/Endgame Score
+// ============================================================================
+// One 32-bit integer carries both halves: the endgame value in the upper 16
+// bits and the middlegame value in the lower 16 bits. Addition, subtraction
+// and multiplication by an int act on both halves at once, so terms can be
+// summed without caring about the game phase until the final Taper().
+
+#include <cstdint>
+
+enum Score : int { SCORE_ZERO = 0 };
+
+inline constexpr Score MakeScore( int mg, int eg ) {
+    return Score( static_cast<int>( static_cast<unsigned int>( eg ) << 16 ) + mg );
+}
+
+// Extract the middlegame half (sign-extended lower 16 bits)
+inline constexpr int MgValue( Score s ) {
+    return static_cast<int16_t>( static_cast<uint16_t>( static_cast<unsigned int>( s ) ) );
+}
+
+// Extract the endgame half, rounding up to undo the borrow of a negative mg half
+inline constexpr int EgValue( Score s ) {
+    return static_cast<int16_t>( static_cast<uint16_t>( ( static_cast<unsigned int>( s ) + 0x8000 ) >> 16 ) );
+}
+
+inline constexpr Score operator+( Score a, Score b ) { return Score( int( a ) + int( b ) ); }
+inline constexpr Score operator-( Score a, Score b ) { return Score( int( a ) - int( b ) ); }
+inline constexpr Score operator-( Score s ) { return Score( -int( s ) ); }
+inline constexpr Score operator*( Score s, int i ) { return Score( int( s ) * i ); }
+inline constexpr Score operator*( int i, Score s ) { return Score( int( s ) * i ); }
+inline Score &operator+=( Score &a, Score b ) { return a = a + b; }
+inline Score &operator-=( Score &a, Score b ) { return a = a - b; }
+
+// Scale a raw centipawn pair by per-term weights given in percent
+inline constexpr Score WeightedScore( int mg, int eg, const int ( &weight )[2] ) {
+    return MakeScore( mg * weight[0] / 100, eg * weight[1] / 100 );
+}
+
+// ============================================================================
+// Tapered Evaluation
+// ============================================================================
+
+constexpr int MAX_PHASE = 24; // Full set of minor and major pieces
+
+// Phase rescaled to 0..256 so the blend ends in a shift instead of a divide
+struct PhaseScale {
+    int value[MAX_PHASE + 1];
+};
+
+inline constexpr PhaseScale BuildPhaseScale() {
+    PhaseScale t{};
+    for ( int phase = 0; phase <= MAX_PHASE; phase++ ) {
+        t.value[phase] = ( phase * 256 + MAX_PHASE / 2 ) / MAX_PHASE;
+    }
+    return t;
+}
+
+inline constexpr PhaseScale PHASE_SCALE = BuildPhaseScale();
+
+// Blend the two halves by game phase (MAX_PHASE = middlegame, 0 = endgame).
+// Promotions can push the phase past MAX_PHASE, so it is clamped.
+inline constexpr int Taper( Score s, int phase ) {
+    int p = PHASE_SCALE.value[phase > MAX_PHASE ? MAX_PHASE : phase];
+    return ( MgValue( s ) * p + EgValue( s ) * ( 256 - p ) ) >> 8;
+}
+
+static_assert( MgValue( MakeScore( -7, 12 ) ) == -7 && EgValue( MakeScore( -7, 12 ) ) == 12 );
+static_assert( MgValue( MakeScore( 3, -9 ) * 2 ) == 6 && EgValue( MakeScore( 3, -9 ) * 2 ) == -18 );
+static_assert( Taper( MakeScore( 100, 200 ), MAX_PHASE ) == 100 && Taper( MakeScore( 100, 200 ), 0 ) == 200 );
@@ -1,77 +1,281 @@
 #pragma once
 
 #include "board.h"
+#include "book.h"
+#include "eval_cache.h"
 #include "evaluate.h"
+#include "profiler.h"
+#include "tt.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <climits>
 #include <cstdio>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <shared_mutex>
 #include <vector>
 
+// ============================================================================
+// Search Engine
+// ============================================================================
+// The engine holds only settings and shared resources: the attack and
+// evaluation tables are compile-time or read-only statics, the optional
+// transposition table is lockless and the optional opening book is a
+// read-only mapping. Everything a search writes lives in a
+// SearchContext that each FindBestMove or Think call builds for itself, so
+// the search functions are const and one engine can serve several threads
+// at once.
+
 class SearchEngine {
   public:
     static constexpr int MAX_DEPTH = 50;
     static const int MAX_EVAL = 100000; // Large value for alpha-beta bounds
 
-    SearchEngine() : nodesSearched( 0 ), nextMove( 0, 0 ) {}
+    // Copy-make: every child position is a copy in a ply-indexed array, so
+    // nothing is undone on the way back up. Off means make/unmake in place.
+    bool copyMake = false;
+
+    // Set from any thread to abort every search in progress on this engine;
+    // each then returns the best root move it completed. The caller clears
+    // it before starting the next search; node and time limits never set it.
+    std::atomic<bool> stop{ false };
+
+    // Progress lines on stdout; headless front ends turn them off
+    bool verbose = true;
+
+    // Optional transposition table, possibly shared with other engines
+    // searching the same position. Without one the search is unchanged.
+    TranspositionTable *tt = nullptr;
+
+    // Optional opening book; a position it knows is answered without a search
+    const OpeningBook *book = nullptr;
+
+    // Limits for Think; zero means unlimited
+    struct SearchLimits {
+        int depth = MAX_DEPTH;
+        uint64_t nodes = 0;
+        int64_t milliseconds = 0;
+        int startDepth = 1; // Lazy SMP helpers start deeper to spread out
+    };
+
+    // Where the time of one search went, filled by PROFILE_SCOPE timers
+    // (all zero when built with CHESS_NO_PROFILE)
+    struct SearchProfile {
+        double totalSeconds = 0;
+        double moveGenSeconds = 0; // Legal move generation and ordering below the root
+        double evalSeconds = 0;    // Static evaluations that missed the cache
+    };
 
     struct SearchResult {
         Move bestMove;
         int score;
         int depth;
-        int nodesSearched;
+        uint64_t nodesSearched;
+        std::vector<Move> pv; // Principal variation, starting with bestMove
+        SearchProfile profile;
 
         SearchResult() : bestMove( 0, 0 ), score( 0 ), depth( 0 ), nodesSearched( 0 ) {}
-        SearchResult( Move move, int s, int d, int nodes )
+        SearchResult( Move move, int s, int d, uint64_t nodes )
             : bestMove( move ), score( s ), depth( d ), nodesSearched( nodes ) {}
     };
 
+    // Per-thread static evaluation cache, shared by every search on the thread
+    static EvalCache &EvalTable() {
+        thread_local EvalCache table;
+        return table;
+    }
+
+    // Nodes searched since ResetNodesSearched by every search on this
+    // engine, readable from any thread; updated every 1024 nodes
+    uint64_t NodesSearched() const { return publishedNodes.load( std::memory_order_relaxed ); }
+    void ResetNodesSearched() { publishedNodes.store( 0, std::memory_order_relaxed ); }
+
   private:
-    int nodesSearched;
-    Move nextMove;
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::atomic<uint64_t> publishedNodes{ 0 };
+
+    // Per-search state, owned by one thread for the length of one call
+    struct SearchContext {
+        uint64_t nodesSearched = 0; // Of the current iteration
+        SearchProfile profile;
+
+        // Limits for Think; FindBestMove runs with none
+        uint64_t nodeLimit = 0;
+        uint64_t nodesBefore = 0;    // Nodes of the completed iterations
+        uint64_t nodesPublished = 0; // Share of publishedNodes already added
+        bool hasDeadline = false;
+        bool limitReached = false;
+        Clock::time_point deadline;
+
+        // The root is a bitbase ending, so wins below it are searched on
+        bool rootInBitbase = false;
+
+        std::vector<Board> boardStack; // [ply], used in copy-make mode
+        NNUE::AccumulatorStack nnue;   // [ply], in both modes
+
+        // Triangular PV table: pvTable[ply] is the best line found from ply on
+        std::vector<std::vector<Move>> pvTable;
+
+        SearchContext() : boardStack( MAX_DEPTH + 1 ), nnue( MAX_DEPTH + 1 ), pvTable( MAX_DEPTH + 2 ) {}
+    };
+
+    bool Stopped( const SearchContext &context ) const {
+        return context.limitReached || stop.load( std::memory_order_relaxed );
+    }
+
+    void PublishNodes( SearchContext &context, uint64_t nodes ) const {
+        publishedNodes.fetch_add( nodes - context.nodesPublished, std::memory_order_relaxed );
+        context.nodesPublished = nodes;
+    }
+
+    // Ends this search once a node or time limit is reached; the clock is
+    // read every 1024 nodes
+    void CheckLimits( SearchContext &context ) const {
+        uint64_t nodes = context.nodesBefore + context.nodesSearched;
+        if ( ( context.nodesSearched & 1023 ) == 0 ) {
+            PublishNodes( context, nodes );
+            if ( context.hasDeadline && Clock::now() >= context.deadline )
+                context.limitReached = true;
+        }
+        if ( context.nodeLimit && nodes >= context.nodeLimit )
+            context.limitReached = true;
+    }
+
+    // Move the transposition table's best move, if it is in the list, to the front
+    static void PromoteMove( std::vector<Move> &moves, const TranspositionTable::Hit &hit ) {
+        for ( size_t i = 1; i < moves.size(); i++ ) {
+            if ( hit.Matches( moves[i] ) ) {
+                std::rotate( moves.begin(), moves.begin() + i, moves.begin() + i + 1 );
+                return;
+            }
+        }
+    }
+    static void UpdatePv( SearchContext &context, int ply, const Move &move ) {
+        std::vector<Move> &line = context.pvTable[ply];
+        line.clear();
+        line.push_back( move );
+        line.insert( line.end(), context.pvTable[ply + 1].begin(), context.pvTable[ply + 1].end() );
+    }
+
+    static constexpr uint64_t NNUE_CACHE_SALT = 0x9E3779B97F4A7C15ULL;
+
+    // Static evaluation (white-relative), through the evaluation cache.
+    // NNUE evaluations are keyed apart, and apart per network, so switching
+    // evaluators or loading a network never reads a stale entry. The odd
+    // multiplier keeps the salts of different networks distinct and nonzero.
+    static int StaticEval( SearchContext &context, Board &board ) {
+        uint64_t key =
+            board.hashKey ^ ( NNUE::IsActive() ? NNUE_CACHE_SALT * ( 2 * NNUE::NetworkId() + 1 ) : 0 );
+        int eval;
+        if ( EvalTable().Probe( key, eval ) )
+            return eval;
+
+        {
+            PROFILE_SCOPE( context.profile.evalSeconds );
+            eval = Evaluator::Evaluate( board, false, &context.nnue );
+        }
+        EvalTable().Store( key, eval );
+        return eval;
+    }
+
+    // Entries of an earlier network can no longer be hit and only crowd the
+    // table, so a thread's first search after a load starts it empty
+    static void DropStaleEvals() {
+        thread_local uint64_t cachedNetwork = 0;
+        if ( cachedNetwork != NNUE::NetworkId() ) {
+            EvalTable().Clear();
+            cachedNetwork = NNUE::NetworkId();
+        }
+    }
+
+    // Position after playing move at ply: the board itself, or in copy-make
+    // mode a copy at ply + 1 that leaves the parent untouched. Either way the
+    // move's accumulator changes go on the stack at ply + 1.
+    Board &Play( SearchContext &context, Board &board, Move &move, int ply ) const {
+        Board *child = &board;
+        if ( copyMake ) {
+            child = &context.boardStack[ply + 1];
+            *child = board;
+        }
+        child->MakeMove( move );
+        context.nnue.Push( *child, move );
+        return *child;
+    }
+
+    void Retract( SearchContext &context, Board &board, const Move &move ) const {
+        context.nnue.Pop();
+        if ( !copyMake )
+            board.UndoMove( move );
+    }
 
     // Negamax Alpha-Beta implementation
-    int FindMoveNegaMaxAlphaBeta( Board &board, std::vector<Move> &validMoves, int depth, int alpha, int beta,
-                                  int turnMultiplier, int maxDepth ) {
-        nodesSearched++;
+    int FindMoveNegaMaxAlphaBeta( SearchContext &context, Board &board, std::vector<Move> &validMoves, int depth,
+                                  int alpha, int beta, int turnMultiplier, int maxDepth ) const {
+        context.nodesSearched++;
+        CheckLimits( context );
+
+        if ( Stopped( context ) )
+            return 0; // Unwinding; the caller discards this score
+
+        int ply = maxDepth - depth;
+        context.pvTable[ply].clear();
+
+        // Bitbase endings are exact: a draw needs no search, and neither does
+        // a line that converts into a known win, which scores as the
+        // evaluation's win. Below a root already in such an ending, wins are
+        // searched on so the evaluation can show progress toward the mate.
+        Bitbases::Outcome known = Bitbases::Probe( board );
+        if ( known == Bitbases::DRAWN )
+            return Evaluator::DRAW;
+        if ( known == Bitbases::WON && !context.rootInBitbase )
+            return turnMultiplier * StaticEval( context, board );
 
         if ( depth == 0 ) {
-            return turnMultiplier * Evaluator::Evaluate( board );
+            return turnMultiplier * StaticEval( context, board );
             /*return Quiescence(board, alpha, beta, turnMultiplier);*/
         }
 
+        int alphaOrig = alpha;
+        TranspositionTable::Hit hit;
+        if ( tt && tt->Probe( board.hashKey, hit ) ) {
+            if ( hit.depth >= depth &&
+                 ( hit.bound == BOUND_EXACT || ( hit.bound == BOUND_LOWER && hit.score >= beta ) ||
+                   ( hit.bound == BOUND_UPPER && hit.score <= alpha ) ) ) {
+                return hit.score;
+            }
+            if ( hit.HasMove() )
+                PromoteMove( validMoves, hit );
+        }
+
         int maxScore = -MAX_EVAL;
         Move localBestMove = validMoves.empty() ? Move( 0, 0 ) : validMoves[0];
 
         for ( auto &move : validMoves ) {
-            board.MakeMove( move );
+            Board &child = Play( context, board, move, ply );
             std::vector<Move> nextMoves;
-            GameState::GenerateAllLegalMoves( board, nextMoves, board.whiteToMove );
-            OrderMoves( board, nextMoves );
+            {
+                PROFILE_SCOPE( context.profile.moveGenSeconds );
+                GameState::GenerateAllLegalMoves( child, nextMoves, child.whiteToMove );
+                OrderMoves( child, nextMoves );
+            }
 
             // Negamax recursive call - negate result and swap alpha/beta
-            int score =
-                -FindMoveNegaMaxAlphaBeta( board, nextMoves, depth - 1, -beta, -alpha, -turnMultiplier, maxDepth );
+            int score = -FindMoveNegaMaxAlphaBeta( context, child, nextMoves, depth - 1, -beta, -alpha,
+                                                   -turnMultiplier, maxDepth );
 
             if ( score > maxScore ) {
                 maxScore = score;
                 localBestMove = move;
-
-                // Store best move at root level (check if this is the initial
-                // depth)
-                if ( depth == maxDepth ) {
-                    nextMove = move;
-                    /*std::cout << "Best move updated: " << move.ToString()*/
-                    /*          << " Score: " << std::fixed*/
-                    /*          << std::setprecision(5) << score << std::endl;*/
-
-                    std::cout << "Depth: " << depth << " Move: " << move.ToString()
-                              << " Score: " << score * turnMultiplier << " (Raw: " << score << ")" << std::endl;
-                }
+                UpdatePv( context, ply, move );
             }
 
-            board.UndoMove( move );
+            Retract( context, board, move );
+
+            if ( Stopped( context ) )
+                break;
 
             // Alpha-beta pruning logic
             if ( maxScore > alpha ) {
@@ -83,11 +287,16 @@ class SearchEngine {
             }
         }
 
+        if ( tt && !Stopped( context ) ) {
+            Bound bound = maxScore <= alphaOrig ? BOUND_UPPER : maxScore >= beta ? BOUND_LOWER : BOUND_EXACT;
+            tt->Store( board.hashKey, maxScore, depth, bound, validMoves.empty() ? nullptr : &localBestMove );
+        }
+
         return maxScore;
     }
 
     // Move ordering functions
-    void OrderMoves( Board &board, std::vector<Move> &moves ) {
+    static void OrderMoves( Board &board, std::vector<Move> &moves ) {
         std::sort( moves.begin(), moves.end(), [&]( const Move &a, const Move &b ) {
             // Prioritize captures (MVV-LVA: Most Valuable Victim -
             // Least Valuable Attacker)
@@ -115,21 +324,19 @@ class SearchEngine {
         } );
     }
 
-    int GetPieceValue( Board &board, int square ) {
-        uint64_t mask = 1ULL << square;
-        for ( int i = 0; i < 12; i++ ) {
-            if ( board.bitboards[i] & mask ) {
-                return Evaluator::PIECE_VALUES[i % 6];
-            }
-        }
-        return 0;
+    static int GetPieceValue( Board &board, int square ) {
+        int piece = board.mailbox[square];
+        return piece == NO_PIECE ? 0 : Evaluator::PIECE_VALUES[piece % 6];
     }
 
     // Quiescence search for tactical positions
-    int Quiescence( Board &board, int alpha, int beta, int turnMultiplier ) {
-        nodesSearched++;
+    int Quiescence( SearchContext &context, Board &board, int alpha, int beta, int turnMultiplier ) const {
+        context.nodesSearched++;
+
+        if ( Stopped( context ) )
+            return 0;
 
-        int standPat = turnMultiplier * Evaluator::Evaluate( board );
+        int standPat = turnMultiplier * StaticEval( context, board );
 
         if ( standPat >= beta ) {
             return beta;
@@ -153,7 +360,9 @@ class SearchEngine {
 
         for ( auto &move : captures ) {
             board.MakeMove( move );
-            int score = -Quiescence( board, -beta, -alpha, -turnMultiplier );
+            context.nnue.Push( board, move );
+            int score = -Quiescence( context, board, -beta, -alpha, -turnMultiplier );
+            context.nnue.Pop();
             board.UndoMove( move );
 
             if ( score >= beta ) {
@@ -167,18 +376,34 @@ class SearchEngine {
         return alpha;
     }
 
-  public:
-    SearchResult FindBestMove( Board &board, int maxDepth = 6 ) {
-        nodesSearched = 0;
-        nextMove = Move( 0, 0 ); // Reset best move
+    // One fixed-depth search. The preferred move (the previous iteration's
+    // best), or else the transposition table's, is searched first.
+    SearchResult SearchRoot( SearchContext &context, Board &board, int maxDepth,
+                             const Move *preferred = nullptr ) const {
+        maxDepth = std::min( maxDepth, MAX_DEPTH ); // Bounds the copy-make board stack
+        context.nodesSearched = 0;
+        Move bestMove( 0, 0 );
+        context.pvTable[0].clear();
+        DropStaleEvals();
+        uint64_t cacheProbes = EvalTable().probes;
+        uint64_t cacheHits = EvalTable().hits;
 
         std::vector<Move> rootMoves;
         GameState::GenerateAllLegalMoves( board, rootMoves, board.whiteToMove );
         if ( rootMoves.empty() ) {
             return SearchResult();
         }
+        context.rootInBitbase = Bitbases::Probe( board ) != Bitbases::UNKNOWN;
+        context.nnue.Reset( board );
 
         OrderMoves( board, rootMoves );
+        TranspositionTable::Hit hit;
+        if ( preferred ) {
+            hit = { 0, 0, BOUND_NONE, preferred->fromSquare, preferred->toSquare, preferred->promotedPiece };
+            PromoteMove( rootMoves, hit );
+        } else if ( tt && tt->Probe( board.hashKey, hit ) && hit.HasMove() ) {
+            PromoteMove( rootMoves, hit );
+        }
 
         int alpha = -MAX_EVAL;
         int beta = MAX_EVAL;
@@ -186,22 +411,31 @@ class SearchEngine {
         int bestScore = -MAX_EVAL;
 
         for ( auto &move : rootMoves ) {
-            board.MakeMove( move );
+            Board &child = Play( context, board, move, 0 );
             std::vector<Move> nextMoves;
-            GameState::GenerateAllLegalMoves( board, nextMoves, board.whiteToMove );
-            OrderMoves( board, nextMoves );
+            {
+                PROFILE_SCOPE( context.profile.moveGenSeconds );
+                GameState::GenerateAllLegalMoves( child, nextMoves, child.whiteToMove );
+                OrderMoves( child, nextMoves );
+            }
 
-            int score =
-                -FindMoveNegaMaxAlphaBeta( board, nextMoves, maxDepth - 1, -beta, -alpha, -turnMultiplier, maxDepth );
+            int score = -FindMoveNegaMaxAlphaBeta( context, child, nextMoves, maxDepth - 1, -beta, -alpha,
+                                                   -turnMultiplier, maxDepth );
 
-            board.UndoMove( move );
+            Retract( context, board, move );
+
+            if ( Stopped( context ) )
+                break; // This move's score is incomplete
 
             if ( score > bestScore ) {
                 bestScore = score;
-                nextMove = move;
-                std::cout << "Root: " << move.ToString()
-                          << " Score: " << score * turnMultiplier // Show score from white's perspective
-                          << std::endl;
+                bestMove = move;
+                UpdatePv( context, 0, move );
+                if ( verbose ) {
+                    std::cout << "Root: " << move.ToString()
+                              << " Score: " << score * turnMultiplier // Show score from white's perspective
+                              << std::endl;
+                }
             }
 
             alpha = std::max( alpha, score );
@@ -210,6 +444,93 @@ class SearchEngine {
             }
         }
 
-        return SearchResult( nextMove, bestScore * turnMultiplier, maxDepth, nodesSearched );
+        cacheProbes = EvalTable().probes - cacheProbes;
+        cacheHits = EvalTable().hits - cacheHits;
+        if ( verbose ) {
+            std::cout << "Eval cache: " << cacheHits << "/" << cacheProbes << " hits ("
+                      << ( cacheProbes ? 100 * cacheHits / cacheProbes : 0 ) << "%)" << std::endl;
+        }
+
+        if ( tt && !Stopped( context ) && !context.pvTable[0].empty() )
+            tt->Store( board.hashKey, bestScore, maxDepth, BOUND_EXACT, &bestMove );
+
+        SearchResult result( bestMove, bestScore * turnMultiplier, maxDepth, context.nodesSearched );
+        result.pv = context.pvTable[0];
+        return result;
+    }
+
+    // A book move as a depth 0 result whose pv is the move alone
+    bool BookMove( Board &board, SearchResult &result ) const {
+        Move move( 0, 0 );
+        if ( !book || !book->Probe( board, move ) )
+            return false;
+        result = SearchResult( move, 0, 0, 0 );
+        result.pv.push_back( move );
+        if ( verbose )
+            std::cout << "Book move: " << move.ToString() << std::endl;
+        return true;
+    }
+
+  public:
+    SearchResult FindBestMove( Board &board, int maxDepth = 6 ) const {
+        SearchResult result;
+        if ( BookMove( board, result ) )
+            return result;
+
+        std::shared_lock<std::shared_mutex> network( NNUE::networkMutex ); // No network swap mid-search
+        SearchContext context;
+        {
+            PROFILE_SCOPE( context.profile.totalSeconds );
+            result = SearchRoot( context, board, maxDepth );
+        }
+        PublishNodes( context, result.nodesSearched );
+        result.profile = context.profile;
+        return result;
+    }
+
+    // Iterative deepening until a limit is reached or stop is set. Each
+    // completed depth is passed to onIteration. Returns the deepest result
+    // with a fully searched best move: a stopped iteration still counts if
+    // it finished its first root move, which is the previous best. A book
+    // move returns at once, without iterations.
+    SearchResult Think( Board &board, const SearchLimits &limits,
+                        const std::function<void( const SearchResult & )> &onIteration = nullptr ) const {
+        SearchResult bookResult;
+        if ( BookMove( board, bookResult ) )
+            return bookResult;
+
+        std::shared_lock<std::shared_mutex> network( NNUE::networkMutex ); // No network swap mid-search
+        SearchContext context;
+        Clock::time_point start = Clock::now();
+        context.nodeLimit = limits.nodes;
+        context.hasDeadline = limits.milliseconds > 0;
+        context.deadline = start + std::chrono::milliseconds( limits.milliseconds );
+
+        SearchResult best;
+        {
+            PROFILE_SCOPE( context.profile.totalSeconds );
+            int maxDepth = std::min( limits.depth, MAX_DEPTH );
+            for ( int depth = std::min( limits.startDepth, maxDepth ); depth <= maxDepth; depth++ ) {
+                SearchResult result =
+                    SearchRoot( context, board, depth, best.pv.empty() ? nullptr : &best.bestMove );
+                context.nodesBefore += result.nodesSearched;
+                if ( !result.pv.empty() )
+                    best = result;
+                best.nodesSearched = context.nodesBefore;
+                PublishNodes( context, context.nodesBefore );
+
+                if ( Stopped( context ) )
+                    break;
+                if ( onIteration )
+                    onIteration( best );
+
+                // Another iteration takes several times longer; don't start one that can't finish
+                if ( context.hasDeadline && Clock::now() - start > ( context.deadline - start ) / 2 )
+                    break;
+            }
+        }
+
+        best.profile = context.profile;
+        return best;
     }
 };
@@ -0,0 +1,113 @@
+#pragma once
+
+// ============================================================================
+// Transposition Table
+// ============================================================================
+// Search results keyed by Board::hashKey: score, depth, bound type and best
+// move. One table can be shared by every thread of a search. Each entry is
+// two relaxed atomics, the data word and key ^ data; a slot half-written by
+// another thread fails the key check on probe instead of returning a wrong
+// result, so no locks are needed.
+//
+// Data word layout (bits): score 0-31, depth 32-39, bound 40-41,
+// from 42-47, to 48-53, promoted piece + 1 54-57. from == to means no move.
+
+#include "move.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+enum Bound : uint8_t { BOUND_NONE, BOUND_UPPER, BOUND_LOWER, BOUND_EXACT };
+
+class TranspositionTable {
+  public:
+    static constexpr size_t DEFAULT_MB = 16;
+
+    struct Hit {
+        int score;
+        int depth;
+        Bound bound;
+        int fromSquare;
+        int toSquare;
+        int promotedPiece;
+
+        bool HasMove() const { return fromSquare != toSquare; }
+        bool Matches( const Move &move ) const {
+            return move.fromSquare == fromSquare && move.toSquare == toSquare && move.promotedPiece == promotedPiece;
+        }
+    };
+
+    explicit TranspositionTable( size_t megabytes = DEFAULT_MB ) { Resize( megabytes ); }
+
+    // Largest power-of-two entry count that fits; clears the table
+    void Resize( size_t megabytes ) {
+        size_t entries = 1;
+        while ( entries * 2 * sizeof( Entry ) <= megabytes * 1024 * 1024 )
+            entries *= 2;
+        table.reset( new Entry[entries] );
+        mask = entries - 1;
+        Clear();
+    }
+
+    // Not safe while a search is running
+    void Clear() {
+        for ( size_t i = 0; i <= mask; i++ ) {
+            table[i].check.store( 0, std::memory_order_relaxed );
+            table[i].data.store( 0, std::memory_order_relaxed );
+        }
+    }
+
+    bool Probe( uint64_t key, Hit &hit ) const {
+        const Entry &entry = table[key & mask];
+        uint64_t data = entry.data.load( std::memory_order_relaxed );
+        if ( ( entry.check.load( std::memory_order_relaxed ) ^ data ) != key || data == 0 )
+            return false;
+
+        hit.score = static_cast<int32_t>( data & 0xFFFFFFFF );
+        hit.depth = static_cast<int>( ( data >> 32 ) & 0xFF );
+        hit.bound = static_cast<Bound>( ( data >> 40 ) & 0x3 );
+        hit.fromSquare = static_cast<int>( ( data >> 42 ) & 0x3F );
+        hit.toSquare = static_cast<int>( ( data >> 48 ) & 0x3F );
+        hit.promotedPiece = static_cast<int>( ( data >> 54 ) & 0xF ) - 1;
+        return true;
+    }
+
+    // Replaces a different position, or the same one searched no deeper
+    void Store( uint64_t key, int score, int depth, Bound bound, const Move *best ) {
+        Entry &entry = table[key & mask];
+        uint64_t old = entry.data.load( std::memory_order_relaxed );
+        bool samePosition = ( entry.check.load( std::memory_order_relaxed ) ^ old ) == key && old != 0;
+        if ( samePosition && static_cast<int>( ( old >> 32 ) & 0xFF ) > depth && bound != BOUND_EXACT )
+            return;
+
+        uint64_t data = static_cast<uint32_t>( score ) | static_cast<uint64_t>( depth & 0xFF ) << 32 |
+                        static_cast<uint64_t>( bound ) << 40;
+        if ( best ) {
+            data |= static_cast<uint64_t>( best->fromSquare ) << 42 | static_cast<uint64_t>( best->toSquare ) << 48 |
+                    static_cast<uint64_t>( best->promotedPiece + 1 ) << 54;
+        }
+        entry.check.store( key ^ data, std::memory_order_relaxed );
+        entry.data.store( data, std::memory_order_relaxed );
+    }
+
+    // Used entries per thousand, sampled from the start of the table
+    int HashFull() const {
+        size_t sample = std::min<size_t>( 1000, mask + 1 );
+        int used = 0;
+        for ( size_t i = 0; i < sample; i++ )
+            used += table[i].data.load( std::memory_order_relaxed ) != 0;
+        return static_cast<int>( used * 1000 / sample );
+    }
+
+    size_t Entries() const { return mask + 1; }
+
+  private:
+    struct Entry {
+        std::atomic<uint64_t> check{ 0 }; // key ^ data
+        std::atomic<uint64_t> data{ 0 };
+    };
+
+    std::unique_ptr<Entry[]> table;
+    size_t mask = 0;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+// ============================================================================
+// Zobrist Keys
+// ============================================================================
+// Random keys for incremental position hashing, generated at compile time
+// with splitmix64 so every build and every thread sees the same values.
+
+#include <cstdint>
+
+namespace Zobrist {
+
+struct Keys {
+    uint64_t pieceSquare[12][64]; // One key per piece per square
+    uint64_t pawnSquare[12][64];  // Same keys for pawns, zero for other pieces
+    uint64_t castling[16];        // Indexed by the castling rights bit set
+    uint64_t sideToMove;          // Toggled when black is to move
+};
+
+inline constexpr uint64_t SplitMix64( uint64_t &state ) {
+    uint64_t z = ( state += 0x9E3779B97F4A7C15ULL );
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+    return z ^ ( z >> 31 );
+}
+
+inline constexpr Keys BuildKeys() {
+    Keys keys{};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+
+    for ( int piece = 0; piece < 12; piece++ ) {
+        for ( int sq = 0; sq < 64; sq++ ) {
+            keys.pieceSquare[piece][sq] = SplitMix64( state );
+            bool isPawn = piece == 0 || piece == 6;
+            keys.pawnSquare[piece][sq] = isPawn ? keys.pieceSquare[piece][sq] : 0ULL;
+        }
+    }
+    for ( int rights = 0; rights < 16; rights++ ) {
+        keys.castling[rights] = SplitMix64( state );
+    }
+    keys.sideToMove = SplitMix64( state );
+    return keys;
+}
+
+inline constexpr Keys KEYS = BuildKeys();
+
+} // namespace Zobrist
@@ -0,0 +1,306 @@
+// ============================================================================
+// Analysis Load Generator
+// ============================================================================
+// Drives analysis_server with concurrent connections, each sending batches
+// of the bench positions and waiting for a batch's "done" before sending
+// the next. Reports throughput and per-job latency (batch sent to result
+// received) as seen by the client, then the server's own metrics.
+//
+// --check-fens instead sends malformed and illegal positions, expects a
+// "bad fen" error for each and a result for the valid ones among them, then
+// checks that the server still answers a normal batch. Exits non-zero if
+// it does not.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/analysis_load.cpp -o build/analysis_load
+//   ./build/analysis_load [--socket PATH] [--connections N] [--batches N] [--batch-size N]
+//                         [--depth N | --nodes N | --movetime MS]
+//   ./build/analysis_load --check-fens [--socket PATH]
+
+#include "bench.h"
+#include "line_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static constexpr const char *DEFAULT_SOCKET = "/tmp/chess-analysis.sock";
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string socketPath = DEFAULT_SOCKET;
+    int connections = 4;
+    int batches = 10;
+    int batchSize = 16;
+    std::string limits = "depth 4";
+};
+
+// ============================================================================
+// Socket Lines
+// ============================================================================
+
+static int Connect( const std::string &path ) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy( address.sun_path, path.c_str(), sizeof( address.sun_path ) - 1 );
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd >= 0 && connect( fd, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) == 0 )
+        return fd;
+    if ( fd >= 0 )
+        close( fd );
+    return -1;
+}
+
+static bool SendAll( int fd, const std::string &text ) {
+    for ( size_t sent = 0; sent < text.size(); ) {
+        ssize_t written = send( fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL );
+        if ( written < 0 && errno == EINTR )
+            continue;
+        if ( written <= 0 )
+            return false;
+        sent += written;
+    }
+    return true;
+}
+
+// ============================================================================
+// Load
+// ============================================================================
+
+struct ClientTotals {
+    uint64_t results = 0, errors = 0, nodes = 0;
+    std::vector<double> latencies; // Milliseconds
+    bool failed = false;
+};
+
+// One connection's share of the load; positions are dealt round-robin from
+// the bench set, offset per connection so the connections differ
+static void RunClient( const Options &options, int client, ClientTotals &totals ) {
+    int fd = Connect( options.socketPath );
+    if ( fd < 0 ) {
+        fprintf( stderr, "Connection %d: cannot connect to %s: %s\n", client, options.socketPath.c_str(),
+                 strerror( errno ) );
+        totals.failed = true;
+        return;
+    }
+    LineReader reader( fd );
+    size_t next = static_cast<size_t>( client ) * 7;
+
+    for ( int b = 0; b < options.batches && !totals.failed; b++ ) {
+        std::string tag = "c" + std::to_string( client ) + "b" + std::to_string( b );
+        std::string request = "batch " + tag + " " + std::to_string( options.batchSize ) + "\n";
+        for ( int j = 0; j < options.batchSize; j++ ) {
+            const char *fen = Bench::POSITIONS[next++ % std::size( Bench::POSITIONS )];
+            request += std::to_string( j ) + " " + options.limits + " fen " + fen + "\n";
+        }
+
+        Clock::time_point sent = Clock::now();
+        if ( !SendAll( fd, request ) ) {
+            totals.failed = true;
+            break;
+        }
+
+        std::string line;
+        while ( true ) {
+            if ( !reader.Next( line ) ) {
+                fprintf( stderr, "Connection %d: server closed the connection\n", client );
+                totals.failed = true;
+                break;
+            }
+            std::istringstream in( line );
+            std::string kind, replyTag;
+            in >> kind >> replyTag;
+            if ( kind == "done" && replyTag == tag )
+                break;
+            if ( kind == "error" ) {
+                totals.errors++;
+                fprintf( stderr, "Connection %d: %s\n", client, line.c_str() );
+            } else if ( kind == "result" ) {
+                totals.results++;
+                totals.latencies.push_back( std::chrono::duration<double, std::milli>( Clock::now() - sent ).count() );
+                size_t at = line.find( " nodes " );
+                if ( at != std::string::npos )
+                    totals.nodes += strtoull( line.c_str() + at + 7, nullptr, 10 );
+            }
+        }
+    }
+    close( fd );
+}
+
+// ============================================================================
+// FEN Check
+// ============================================================================
+
+struct FenCase {
+    const char *fen;
+    bool valid;
+};
+
+static constexpr FenCase FEN_CASES[] = {
+    { "4k3/8/8/8/8/8/8/4K2R w KQkq -", true },        // Rights without their rooks are dropped
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", true },
+    { "4k3/8/8/8/8/8/8/4K3R w - -", false },          // Nine files
+    { "4k3/8/8/8/8/8/8/4K2 w - -", false },           // Seven files
+    { "4k3/8/8/8/8/8/8/8/4K3 w - -", false },         // Nine ranks
+    { "4k3/8/8/8/8/8/4K3 w - -", false },             // Seven ranks
+    { "4k3/8/8/8/8/8/8/4K2p w - -", false },          // Pawn on the first rank
+    { "4k2P/8/8/8/8/8/8/4K3 w - -", false },          // Pawn on the last rank
+    { "4k3/8/8/8/8/8/8/3KK3 w - -", false },          // Two white kings
+    { "4k3/8/8/8/8/8/8/8 w - -", false },             // No white king
+    { "4k3/8/8/8/8/8/8/4K2X w - -", false },          // Unknown piece
+    { "4k3/8/8/8/8/8/8/4R1K1 w - -", false },         // Side not to move in check
+    { "4k3/8/8/8/8/8/8/4K3 x - -", false },           // No side to move
+    { "4k3/8/8/8/8/8/8/4K3", false },                 // Placement only
+    { "4k3/8/8/8/8/8/8/4K2R w KZ -", false },         // Unknown castling right
+    { "8/8/8/8/8/8/8/8/8/8/8/8/8/4k3 w - -", false }, // Far too many ranks
+};
+
+// Sends one batch and collects its replies by job id; false if the
+// connection failed
+static bool RunBatch( int fd, LineReader &reader, const std::string &tag, const std::vector<std::string> &jobs,
+                      std::vector<std::string> &replies ) {
+    std::string request = "batch " + tag + " " + std::to_string( jobs.size() ) + "\n";
+    for ( size_t j = 0; j < jobs.size(); j++ )
+        request += std::to_string( j ) + " " + jobs[j] + "\n";
+    if ( !SendAll( fd, request ) )
+        return false;
+
+    replies.assign( jobs.size(), "" );
+    std::string line;
+    while ( reader.Next( line ) ) {
+        std::istringstream in( line );
+        std::string kind, replyTag, id;
+        in >> kind >> replyTag >> id;
+        if ( kind == "done" && replyTag == tag )
+            return true;
+        size_t index = static_cast<size_t>( atoi( id.c_str() ) );
+        if ( replyTag == tag && index < jobs.size() )
+            replies[index] = line;
+    }
+    return false;
+}
+
+static int CheckFens( const Options &options ) {
+    int fd = Connect( options.socketPath );
+    if ( fd < 0 ) {
+        fprintf( stderr, "Cannot connect to %s: %s\n", options.socketPath.c_str(), strerror( errno ) );
+        return 1;
+    }
+    LineReader reader( fd );
+    int failures = 0;
+
+    std::vector<std::string> jobs, replies;
+    for ( const FenCase &position : FEN_CASES )
+        jobs.push_back( "depth 3 fen " + std::string( position.fen ) );
+    if ( !RunBatch( fd, reader, "fens", jobs, replies ) ) {
+        fprintf( stderr, "FAIL: the server closed the connection\n" );
+        close( fd );
+        return 1;
+    }
+    for ( size_t i = 0; i < std::size( FEN_CASES ); i++ ) {
+        const FenCase &position = FEN_CASES[i];
+        bool ok = position.valid ? replies[i].rfind( "result ", 0 ) == 0
+                                 : replies[i] == "error fens " + std::to_string( i ) + " bad fen";
+        printf( "%-60s %s\n", position.fen, ok ? "ok" : "FAILED" );
+        if ( !ok ) {
+            printf( "  reply \"%s\"\n", replies[i].c_str() );
+            failures++;
+        }
+    }
+
+    // The server must have survived them all
+    jobs.assign( 1, "depth 2 fen " + std::string( Bench::POSITIONS[0] ) );
+    bool alive = RunBatch( fd, reader, "after", jobs, replies ) && replies[0].rfind( "result ", 0 ) == 0;
+    printf( "Server still answers: %s\n", alive ? "ok" : "FAILED" );
+    close( fd );
+    return failures || !alive ? 1 : 0;
+}
+
+static double Percentile( const std::vector<double> &sorted, double q ) {
+    return sorted.empty() ? 0 : sorted[static_cast<size_t>( q * ( sorted.size() - 1 ) )];
+}
+
+int main( int argc, char **argv ) {
+    Options options;
+    bool checkFens = false;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ( arg == "--check-fens" ) {
+            checkFens = true;
+        } else if ( arg == "--socket" && hasValue ) {
+            options.socketPath = argv[++i];
+        } else if ( arg == "--connections" && hasValue ) {
+            options.connections = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--batches" && hasValue ) {
+            options.batches = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--batch-size" && hasValue ) {
+            options.batchSize = std::max( 1, atoi( argv[++i] ) );
+        } else if ( ( arg == "--depth" || arg == "--nodes" || arg == "--movetime" ) && hasValue ) {
+            options.limits = arg.substr( 2 ) + " " + argv[++i];
+        } else {
+            fprintf( stderr,
+                     "Usage: %s [--socket PATH] [--connections N] [--batches N] [--batch-size N]\n"
+                     "       [--depth N | --nodes N | --movetime MS]\n"
+                     "       %s --check-fens [--socket PATH]\n",
+                     argv[0], argv[0] );
+            return 1;
+        }
+    }
+    if ( checkFens )
+        return CheckFens( options );
+
+    printf( "%d connections x %d batches x %d jobs, %s\n", options.connections, options.batches, options.batchSize,
+            options.limits.c_str() );
+    std::vector<ClientTotals> totals( options.connections );
+    std::vector<std::thread> clients;
+    Clock::time_point start = Clock::now();
+    for ( int c = 0; c < options.connections; c++ )
+        clients.emplace_back( RunClient, std::cref( options ), c, std::ref( totals[c] ) );
+    for ( auto &client : clients )
+        client.join();
+    double seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+
+    ClientTotals all;
+    for ( const ClientTotals &client : totals ) {
+        all.results += client.results;
+        all.errors += client.errors;
+        all.nodes += client.nodes;
+        all.failed |= client.failed;
+        all.latencies.insert( all.latencies.end(), client.latencies.begin(), client.latencies.end() );
+    }
+    std::sort( all.latencies.begin(), all.latencies.end() );
+
+    printf( "Results         : %llu (%llu errors)\n", static_cast<unsigned long long>( all.results ),
+            static_cast<unsigned long long>( all.errors ) );
+    printf( "Wall time       : %.2f s\n", seconds );
+    printf( "Positions/s     : %.1f\n", all.results / seconds );
+    printf( "Nodes/second    : %.0f\n", all.nodes / seconds );
+    printf( "Latency (ms)    : p50 %.1f  p95 %.1f  p99 %.1f  max %.1f\n", Percentile( all.latencies, 0.50 ),
+            Percentile( all.latencies, 0.95 ), Percentile( all.latencies, 0.99 ),
+            all.latencies.empty() ? 0 : all.latencies.back() );
+
+    int fd = Connect( options.socketPath );
+    std::string line;
+    if ( fd >= 0 && SendAll( fd, "stats\n" ) ) {
+        LineReader reader( fd );
+        if ( reader.Next( line ) )
+            printf( "Server          : %s\n", line.c_str() );
+    }
+    if ( fd >= 0 )
+        close( fd );
+    return all.failed ? 1 : 0;
+}
@@ -0,0 +1,527 @@
+// ============================================================================
+// Analysis Server
+// ============================================================================
+// Long-lived batch analysis backend on a Unix domain socket. Clients send
+// framed batches of positions with search limits; jobs from every
+// connection go through one queue to a pool of worker threads, and each
+// result is written back as soon as it is found, so a batch's results
+// arrive in completion order, not request order.
+//
+// Every worker owns a SearchEngine, so no search state is shared between
+// jobs; all workers share one lockless transposition table (tt.h), which
+// keeps positions that recur across jobs and batches cheap.
+//
+// Protocol, one newline-terminated line per message:
+//   batch <tag> <count>                                 opens a batch;
+//   <id> [depth N] [nodes N] [movetime MS] fen <FEN>    then count job lines
+//   stats                                               metrics, one line
+// Replies:
+//   result <tag> <id> bestmove <uci> score cp|mate <n> depth <d> nodes <n> queue_ms <q> search_ms <s>
+//   error <tag> <id> <reason>
+//   done <tag> <jobs> <ms>                              the batch's last reply
+//   stats queue <n> peak <n> running <n> completed <n> failed <n> pps <x> queue_ms <p50/p95/p99>
+//         latency_ms <p50/p95/p99>
+// A job without limits searches to DEFAULT_DEPTH. The same metrics go to
+// stderr every --report seconds while jobs are flowing.
+//
+// Build and run (tools/build.sh builds every tool; analysis_load.cpp is the
+// matching load generator):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/analysis_server.cpp -o build/analysis_server
+//   ./build/analysis_server [--socket PATH] [--threads N] [--hash MB] [--report SECONDS]
+
+#include "bitbase.h"
+#include "bitboard.h"
+#include "board.h"
+#include "evaluate.h"
+#include "game_state.h"
+#include "line_reader.h"
+#include "notation.h"
+#include "search.h"
+#include "tt.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static constexpr const char *DEFAULT_SOCKET = "/tmp/chess-analysis.sock";
+static constexpr int DEFAULT_DEPTH = 5;
+static constexpr int MAX_BATCH = 100000;
+static constexpr size_t MAX_LINE = 4096;
+static constexpr size_t LATENCY_SAMPLES = 8192; // Percentiles cover the most recent jobs
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<bool> quitRequested{ false };
+
+static double Milliseconds( Clock::duration duration ) {
+    return std::chrono::duration<double, std::milli>( duration ).count();
+}
+
+// ============================================================================
+// Connections
+// ============================================================================
+
+// A client may half-close after its last batch (shutdown( SHUT_WR ), as
+// nc -N does) and still gets every reply: the end of its input only ends
+// the reader. Searches and replies stop once the peer is gone, which shows
+// as a failed send or as POLLHUP / POLLERR on the socket.
+struct Connection {
+    int fd;
+    std::atomic<bool> open{ true };      // The peer is still there
+    std::atomic<bool> finished{ false }; // Reader thread has returned
+    std::mutex writeMutex;
+
+    explicit Connection( int fd ) : fd( fd ) {}
+    ~Connection() { close( fd ); }
+
+    bool PeerPresent() {
+        pollfd state{ fd, 0, 0 };
+        if ( open.load() && poll( &state, 1, 0 ) > 0 && ( state.revents & ( POLLHUP | POLLERR ) ) )
+            open.store( false );
+        return open.load();
+    }
+
+    // Whole lines only; workers and the reader write concurrently
+    void Send( const std::string &line ) {
+        std::lock_guard<std::mutex> lock( writeMutex );
+        std::string framed = line + '\n';
+        for ( size_t sent = 0; open.load() && sent < framed.size(); ) {
+            ssize_t written = send( fd, framed.data() + sent, framed.size() - sent, MSG_NOSIGNAL );
+            if ( written < 0 && errno == EINTR )
+                continue;
+            if ( written <= 0 ) {
+                open.store( false );
+                return;
+            }
+            sent += written;
+        }
+    }
+};
+
+struct Batch {
+    std::shared_ptr<Connection> connection;
+    std::string tag;
+    int jobs = 0;
+    std::atomic<int> remaining{ 0 };
+    Clock::time_point received;
+};
+
+struct Job {
+    std::shared_ptr<Batch> batch;
+    std::string id;
+    std::string fen;
+    SearchEngine::SearchLimits limits;
+    Clock::time_point enqueued;
+};
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+class Metrics {
+  public:
+    void Completed( double queueMs, double latencyMs ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        queueSamples[completed % LATENCY_SAMPLES] = queueMs;
+        latencySamples[completed % LATENCY_SAMPLES] = latencyMs;
+        completed++;
+    }
+
+    void Failed() {
+        std::lock_guard<std::mutex> lock( mutex );
+        failed++;
+    }
+
+    uint64_t CompletedCount() {
+        std::lock_guard<std::mutex> lock( mutex );
+        return completed;
+    }
+
+    std::string Report( size_t queueDepth, size_t peakDepth, int running ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        double seconds = std::chrono::duration<double>( Clock::now() - started ).count();
+        char line[256];
+        snprintf( line, sizeof( line ),
+                  "stats queue %zu peak %zu running %d completed %llu failed %llu pps %.1f queue_ms %s latency_ms %s",
+                  queueDepth, peakDepth, running, static_cast<unsigned long long>( completed ),
+                  static_cast<unsigned long long>( failed ), completed / std::max( seconds, 1e-9 ),
+                  Percentiles( queueSamples ).c_str(), Percentiles( latencySamples ).c_str() );
+        return line;
+    }
+
+  private:
+    std::mutex mutex;
+    Clock::time_point started = Clock::now();
+    uint64_t completed = 0, failed = 0;
+    std::vector<double> queueSamples = std::vector<double>( LATENCY_SAMPLES );
+    std::vector<double> latencySamples = std::vector<double>( LATENCY_SAMPLES );
+
+    std::string Percentiles( const std::vector<double> &ring ) const {
+        std::vector<double> samples( ring.begin(), ring.begin() + std::min<uint64_t>( completed, ring.size() ) );
+        if ( samples.empty() )
+            return "0/0/0";
+        std::sort( samples.begin(), samples.end() );
+        auto at = [&samples]( double q ) { return samples[static_cast<size_t>( q * ( samples.size() - 1 ) )]; };
+        char text[64];
+        snprintf( text, sizeof( text ), "%.1f/%.1f/%.1f", at( 0.50 ), at( 0.95 ), at( 0.99 ) );
+        return text;
+    }
+};
+
+// ============================================================================
+// Requests
+// ============================================================================
+
+// "<id> [depth N] [nodes N] [movetime MS] fen <FEN>"; false with a reason
+// for anything else, including a FEN without one king per side
+static bool ParseJob( const std::string &line, Job &job, std::string &error ) {
+    std::istringstream in( line );
+    if ( !( in >> job.id ) ) {
+        error = "empty job line";
+        return false;
+    }
+
+    bool limited = false;
+    for ( std::string token; in >> token; ) {
+        if ( token == "fen" ) {
+            std::getline( in >> std::ws, job.fen );
+            break;
+        }
+        long long value = 0;
+        if ( !( in >> value ) || value <= 0 ) {
+            error = "bad value for " + token;
+            return false;
+        }
+        if ( token == "depth" ) {
+            job.limits.depth = static_cast<int>( std::min<long long>( value, SearchEngine::MAX_DEPTH ) );
+        } else if ( token == "nodes" ) {
+            job.limits.nodes = static_cast<uint64_t>( value );
+        } else if ( token == "movetime" ) {
+            job.limits.milliseconds = value;
+        } else {
+            error = "unknown limit " + token;
+            return false;
+        }
+        limited = true;
+    }
+    if ( !limited )
+        job.limits.depth = DEFAULT_DEPTH;
+
+    Board board;
+    if ( !LoadCheckedFen( board, job.fen ) ) {
+        error = "bad fen";
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Server
+// ============================================================================
+
+struct Options {
+    std::string socketPath = DEFAULT_SOCKET;
+    int threads = 1;
+    size_t hashMb = 64;
+    int reportSeconds = 10;
+};
+
+class AnalysisServer {
+  public:
+    explicit AnalysisServer( const Options &options ) : options( options ), tt( options.hashMb ) {}
+
+    int Run() {
+        int listener = Listen();
+        if ( listener < 0 )
+            return 1;
+
+        std::vector<std::thread> workers;
+        for ( int i = 0; i < options.threads; i++ )
+            workers.emplace_back( [this] { WorkerLoop(); } );
+        fprintf( stderr, "Listening on %s with %d workers, %zu MB hash\n", options.socketPath.c_str(),
+                 options.threads, options.hashMb );
+
+        AcceptLoop( listener );
+
+        // Shutdown: no new connections, wake the readers, drop queued jobs
+        close( listener );
+        unlink( options.socketPath.c_str() );
+        for ( auto &[thread, connection] : readers ) {
+            connection->open.store( false );
+            shutdown( connection->fd, SHUT_RDWR );
+        }
+        for ( auto &[thread, connection] : readers )
+            thread.join();
+        {
+            std::lock_guard<std::mutex> lock( queueMutex );
+            queue.clear();
+            closing = true;
+            for ( SearchEngine *engine : engines )
+                engine->stop.store( true );
+        }
+        queueChanged.notify_all();
+        for ( auto &worker : workers )
+            worker.join();
+        fprintf( stderr, "%s\n", Stats().c_str() );
+        return 0;
+    }
+
+  private:
+    const Options &options;
+    TranspositionTable tt;
+    Metrics metrics;
+
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<Job> queue;
+    size_t peakDepth = 0;
+    bool closing = false;
+    std::atomic<int> running{ 0 };
+    std::vector<SearchEngine *> engines; // Stopped on shutdown, under queueMutex
+
+    std::list<std::pair<std::thread, std::shared_ptr<Connection>>> readers;
+
+    int Listen() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if ( options.socketPath.size() >= sizeof( address.sun_path ) ) {
+            fprintf( stderr, "Socket path too long: %s\n", options.socketPath.c_str() );
+            return -1;
+        }
+        strcpy( address.sun_path, options.socketPath.c_str() );
+        unlink( options.socketPath.c_str() ); // A stale socket from an earlier run
+
+        int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+        if ( fd < 0 || bind( fd, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) < 0 ||
+             listen( fd, 64 ) < 0 ) {
+            fprintf( stderr, "Cannot listen on %s: %s\n", options.socketPath.c_str(), strerror( errno ) );
+            if ( fd >= 0 )
+                close( fd );
+            return -1;
+        }
+        return fd;
+    }
+
+    // Accepts until a signal asks to quit; reaps finished readers and
+    // prints the periodic report between connections
+    void AcceptLoop( int listener ) {
+        Clock::time_point lastReport = Clock::now();
+        uint64_t reportedCompleted = 0;
+        while ( !quitRequested.load() ) {
+            pollfd request{ listener, POLLIN, 0 };
+            if ( poll( &request, 1, 250 ) > 0 ) {
+                int fd = accept( listener, nullptr, nullptr );
+                if ( fd >= 0 ) {
+                    auto connection = std::make_shared<Connection>( fd );
+                    readers.emplace_back( std::thread( [this, connection] { ReadLoop( connection ); } ), connection );
+                }
+            }
+
+            for ( auto it = readers.begin(); it != readers.end(); ) {
+                if ( it->second->finished.load() ) {
+                    it->first.join();
+                    it = readers.erase( it );
+                } else {
+                    ++it;
+                }
+            }
+
+            if ( options.reportSeconds > 0 &&
+                 Clock::now() - lastReport >= std::chrono::seconds( options.reportSeconds ) ) {
+                uint64_t completed = metrics.CompletedCount();
+                if ( completed != reportedCompleted || running.load() > 0 )
+                    fprintf( stderr, "%s\n", Stats().c_str() );
+                reportedCompleted = completed;
+                lastReport = Clock::now();
+            }
+        }
+    }
+
+    std::string Stats() {
+        size_t depth, peak;
+        {
+            std::lock_guard<std::mutex> lock( queueMutex );
+            depth = queue.size();
+            peak = peakDepth;
+        }
+        return metrics.Report( depth, peak, running.load() );
+    }
+
+    // One thread per connection: parses batches and queues their jobs
+    void ReadLoop( std::shared_ptr<Connection> connection ) {
+        LineReader reader( connection->fd, MAX_LINE );
+        std::string line;
+        while ( connection->open.load() && reader.Next( line ) ) {
+            std::istringstream in( line );
+            std::string command;
+            in >> command;
+            if ( command.empty() )
+                continue;
+            if ( command == "stats" ) {
+                connection->Send( Stats() );
+                continue;
+            }
+
+            std::string tag;
+            int count = 0;
+            if ( command != "batch" || !( in >> tag >> count ) || count < 1 || count > MAX_BATCH ) {
+                connection->Send( "error - - expected \"batch <tag> <count>\" or \"stats\"" );
+                continue;
+            }
+            if ( !ReadBatch( connection, reader, tag, count ) )
+                break;
+        }
+        connection->finished.store( true ); // Queued batches are still answered
+    }
+
+    // Reads a batch's job lines and queues them all at once, so a batch is
+    // never half-queued; bad lines are answered straight away
+    bool ReadBatch( const std::shared_ptr<Connection> &connection, LineReader &reader, const std::string &tag,
+                    int count ) {
+        auto batch = std::make_shared<Batch>();
+        batch->connection = connection;
+        batch->tag = tag;
+        batch->jobs = count;
+        batch->received = Clock::now();
+
+        std::vector<Job> jobs;
+        std::string line, error;
+        for ( int i = 0; i < count; i++ ) {
+            if ( !reader.Next( line ) )
+                return false;
+            Job job;
+            if ( ParseJob( line, job, error ) ) {
+                job.batch = batch;
+                jobs.push_back( std::move( job ) );
+            } else {
+                connection->Send( "error " + tag + " " + ( job.id.empty() ? "-" : job.id ) + " " + error );
+                metrics.Failed();
+            }
+        }
+
+        batch->remaining.store( static_cast<int>( jobs.size() ) );
+        if ( jobs.empty() ) {
+            FinishBatch( *batch );
+            return true;
+        }
+        {
+            std::lock_guard<std::mutex> lock( queueMutex );
+            Clock::time_point now = Clock::now();
+            for ( Job &job : jobs ) {
+                job.enqueued = now;
+                queue.push_back( std::move( job ) );
+            }
+            peakDepth = std::max( peakDepth, queue.size() );
+        }
+        queueChanged.notify_all();
+        return true;
+    }
+
+    void FinishBatch( const Batch &batch ) {
+        int64_t ms = static_cast<int64_t>( Milliseconds( Clock::now() - batch.received ) );
+        batch.connection->Send( "done " + batch.tag + " " + std::to_string( batch.jobs ) + " " + std::to_string( ms ) );
+    }
+
+    void WorkerLoop() {
+        SearchEngine engine;
+        engine.verbose = false;
+        engine.tt = &tt;
+        {
+            std::lock_guard<std::mutex> lock( queueMutex );
+            engines.push_back( &engine );
+        }
+
+        while ( true ) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock( queueMutex );
+                queueChanged.wait( lock, [this] { return closing || !queue.empty(); } );
+                if ( closing )
+                    return;
+                job = std::move( queue.front() );
+                queue.pop_front();
+                engine.stop.store( false ); // Under the lock, so a shutdown's stop is never lost
+            }
+
+            Batch &batch = *job.batch;
+            if ( batch.connection->PeerPresent() ) // A client that hung up gets no more searches
+                Search( engine, job );
+            if ( batch.remaining.fetch_sub( 1 ) == 1 )
+                FinishBatch( batch );
+        }
+    }
+
+    void Search( SearchEngine &engine, const Job &job ) {
+        running++;
+        Clock::time_point start = Clock::now();
+        Board board;
+        LoadCheckedFen( board, job.fen ); // Checked by ParseJob; this also drops castling rights without a rook
+        SearchEngine::SearchResult result = engine.Think( board, job.limits );
+        Clock::time_point end = Clock::now();
+        running--;
+
+        // No legal moves: mated or stalemated, the score says which
+        if ( result.pv.empty() )
+            result.score = GameState::IsKingInCheck( board, board.whiteToMove )
+                               ? ( board.whiteToMove ? -Evaluator::CHECKMATE : Evaluator::CHECKMATE )
+                               : 0;
+
+        int score = board.whiteToMove ? result.score : -result.score; // Side to move's, as UCI writes it
+        double queueMs = Milliseconds( start - job.enqueued );
+        double searchMs = Milliseconds( end - start );
+        char timing[64];
+        snprintf( timing, sizeof( timing ), " queue_ms %.1f search_ms %.1f", queueMs, searchMs );
+        job.batch->connection->Send( "result " + job.batch->tag + " " + job.id + " bestmove " +
+                                     ( result.pv.empty() ? std::string( "0000" ) : ToUci( result.bestMove ) ) +
+                                     " score " + UciScore( board, score, result.pv ) + " depth " +
+                                     std::to_string( result.depth ) + " nodes " +
+                                     std::to_string( result.nodesSearched ) + timing );
+        metrics.Completed( queueMs, queueMs + searchMs );
+    }
+};
+
+static void RequestQuit( int ) { quitRequested.store( true ); }
+
+int main( int argc, char **argv ) {
+    Options options;
+    options.threads = std::max( 1u, std::thread::hardware_concurrency() );
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ( arg == "--socket" && hasValue ) {
+            options.socketPath = argv[++i];
+        } else if ( arg == "--threads" && hasValue ) {
+            options.threads = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--hash" && hasValue ) {
+            options.hashMb = std::max<size_t>( 1, strtoull( argv[++i], nullptr, 10 ) );
+        } else if ( arg == "--report" && hasValue ) {
+            options.reportSeconds = std::max( 0, atoi( argv[++i] ) );
+        } else {
+            fprintf( stderr, "Usage: %s [--socket PATH] [--threads N] [--hash MB] [--report SECONDS]\n", argv[0] );
+            return 1;
+        }
+    }
+
+    Bitbases::Init();
+    signal( SIGINT, RequestQuit );
+    signal( SIGTERM, RequestQuit );
+    AnalysisServer server( options );
+    return server.Run();
+}
@@ -0,0 +1,202 @@
+// ============================================================================
+// Bitbase Check
+// ============================================================================
+// Builds the endgame bitbases (bitbase.h), reports the build time and the
+// share of won positions, and checks the tables against the engine's own
+// move generator. Exits non-zero on any mismatch.
+//
+//   1. Random legal positions of each ending, with either color as the
+//      strong side, must agree with their successors: the strong side to
+//      move wins when some move wins; the bare king to move loses when it
+//      is mated or every move loses. A move out of the four endings (a
+//      capture, a minor-piece promotion) counts as a draw.
+//   2. KQK and KRK are drawn only by a stalemate or a capture of the piece,
+//      so with the bare king to move the result follows from its moves.
+//   3. A few textbook positions.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/bitbase_check.cpp -o build/bitbase_check
+//   ./build/bitbase_check [--threads N] [--samples N]   (all cores and 200000 by default)
+
+#include "bitbase.h"
+#include "board.h"
+#include "game_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr const char *ENDING_NAMES[Bitbases::ENDING_COUNT] = { "KQK", "KRK", "KPK", "KBNK" };
+
+static int failures = 0;
+
+static void Fail( const std::string &message ) {
+    if ( failures++ < 10 )
+        fprintf( stderr, "FAIL: %s\n", message.c_str() );
+}
+
+static const char *OutcomeName( Bitbases::Outcome outcome ) {
+    return outcome == Bitbases::WON ? "won" : outcome == Bitbases::DRAWN ? "drawn" : "unknown";
+}
+
+static std::string ToFen( const char ( &squares )[64], bool whiteToMove ) {
+    std::string fen;
+    for ( int rank = 7; rank >= 0; rank-- ) {
+        int empty = 0;
+        for ( int file = 0; file < 8; file++ ) {
+            char piece = squares[MakeSquare( rank, file )];
+            if ( !piece ) {
+                empty++;
+                continue;
+            }
+            if ( empty )
+                fen += static_cast<char>( '0' + empty );
+            fen += piece;
+            empty = 0;
+        }
+        if ( empty )
+            fen += static_cast<char>( '0' + empty );
+        if ( rank > 0 )
+            fen += '/';
+    }
+    return fen + ( whiteToMove ? " w - - 0 1" : " b - - 0 1" );
+}
+
+// A random legal position of the ending; false if the draw was not legal
+static bool RandomPosition( Bitbases::Ending ending, std::mt19937_64 &random, Board &board ) {
+    bool strongWhite = random() & 1;
+    char squares[64] = {};
+    int placed[4];
+    int count = 2 + Bitbases::PieceCount( ending );
+    for ( int i = 0; i < count; i++ ) {
+        placed[i] = static_cast<int>( random() % 64 );
+        if ( squares[placed[i]] )
+            return false;
+        int piece;
+        if ( i == 0 )
+            piece = strongWhite ? WK : BK;
+        else if ( i == 1 )
+            piece = strongWhite ? BK : WK;
+        else
+            piece = Bitbases::ENDING_PIECES[ending][i - 2] + ( strongWhite ? 0 : 6 );
+        if ( piece % 6 == WP && ( RankOf( placed[i] ) == 0 || RankOf( placed[i] ) == 7 ) )
+            return false;
+        squares[placed[i]] = PIECE_CHARS[piece];
+    }
+    if ( Attacks::kingAttacks[placed[0]] & 1ULL << placed[1] )
+        return false;
+
+    board = Board();
+    board.LoadFEN( ToFen( squares, random() & 1 ) );
+    return !GameState::IsKingInCheck( board, !board.whiteToMove );
+}
+
+// Phase 1 and 2 for one position
+static void CheckPosition( Bitbases::Ending ending, Board &board ) {
+    Bitbases::Outcome outcome = Bitbases::Probe( board );
+    if ( outcome == Bitbases::UNKNOWN ) {
+        Fail( std::string( ENDING_NAMES[ending] ) + " not covered" );
+        return;
+    }
+    bool strongToMove = board.occupancies[board.whiteToMove ? 0 : 1] != board.bitboards[board.whiteToMove ? WK : BK];
+
+    std::vector<Move> moves;
+    GameState::GenerateAllLegalMoves( board, moves, board.whiteToMove );
+    int won = 0;
+    bool captures = false;
+    for ( Move &move : moves ) {
+        captures |= move.isCapture;
+        board.MakeMove( move );
+        won += Bitbases::Probe( board ) == Bitbases::WON;
+        board.UndoMove( move );
+    }
+
+    bool expectWon;
+    if ( strongToMove )
+        expectWon = won > 0;
+    else if ( moves.empty() )
+        expectWon = GameState::IsKingInCheck( board, board.whiteToMove );
+    else
+        expectWon = won == static_cast<int>( moves.size() );
+
+    if ( expectWon != ( outcome == Bitbases::WON ) )
+        Fail( std::string( ENDING_NAMES[ending] ) + " is " + OutcomeName( outcome ) + " but its moves say otherwise" );
+
+    bool simple = ending == Bitbases::KQK || ending == Bitbases::KRK;
+    bool mated = moves.empty() && GameState::IsKingInCheck( board, board.whiteToMove );
+    if ( simple && !strongToMove && ( outcome == Bitbases::WON ) != ( mated || ( !moves.empty() && !captures ) ) )
+        Fail( std::string( ENDING_NAMES[ending] ) + " with the bare king to move is " + OutcomeName( outcome ) );
+}
+
+struct Textbook {
+    const char *fen;
+    Bitbases::Outcome outcome;
+};
+
+static constexpr Textbook TEXTBOOK[] = {
+    { "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", Bitbases::DRAWN }, // Stalemate
+    { "k7/8/K7/P7/8/8/8/8 w - - 0 1", Bitbases::DRAWN },    // Rook pawn, defender in the corner
+    { "8/8/8/8/8/8/4P3/4K2k w - - 0 1", Bitbases::WON },    // Outside the pawn's square
+    { "4k2K/4p3/8/8/8/8/8/8 b - - 0 1", Bitbases::WON },    // The same, colors reversed
+    { "7r/8/8/8/8/8/5k2/7K w - - 0 1", Bitbases::WON },     // Mated
+    { "8/8/8/8/8/8/8/Kr5k w - - 0 1", Bitbases::DRAWN },    // The rook hangs
+};
+
+int main( int argc, char **argv ) {
+    int threads = std::max( 1, static_cast<int>( std::thread::hardware_concurrency() ) );
+    long samples = 200000;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        if ( arg == "--threads" && i + 1 < argc ) {
+            threads = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--samples" && i + 1 < argc ) {
+            samples = std::max( 1L, atol( argv[++i] ) );
+        } else {
+            fprintf( stderr, "Usage: %s [--threads N] [--samples N]\n", argv[0] );
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Bitbases::Init( threads );
+    double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    printf( "Built in %.2f s on %d threads\n", seconds, threads );
+    for ( int ending = 0; ending < Bitbases::ENDING_COUNT; ending++ ) {
+        const auto &bits = Bitbases::Data().bits[ending];
+        size_t won = 0;
+        for ( uint64_t word : bits )
+            won += PopCount( word );
+        printf( "%-5s %8zu bytes, %9zu won of %9zu entries\n", ENDING_NAMES[ending], bits.size() * 8, won,
+                bits.size() * 64 );
+    }
+
+    std::mt19937_64 random( 1 );
+    for ( int ending = 0; ending < Bitbases::ENDING_COUNT; ending++ ) {
+        int before = failures;
+        Board board;
+        for ( long checked = 0; checked < samples; ) {
+            if ( RandomPosition( static_cast<Bitbases::Ending>( ending ), random, board ) ) {
+                CheckPosition( static_cast<Bitbases::Ending>( ending ), board );
+                checked++;
+            }
+        }
+        printf( "%-5s %ld positions against their moves: %s\n", ENDING_NAMES[ending], samples,
+                failures == before ? "ok" : "FAILED" );
+    }
+
+    int before = failures;
+    for ( const Textbook &position : TEXTBOOK ) {
+        Board board;
+        board.LoadFEN( position.fen );
+        Bitbases::Outcome outcome = Bitbases::Probe( board );
+        if ( outcome != position.outcome )
+            Fail( std::string( position.fen ) + " is " + OutcomeName( outcome ) + ", expected " +
+                  OutcomeName( position.outcome ) );
+    }
+    printf( "Textbook positions: %s\n", failures == before ? "ok" : "FAILED" );
+    return failures ? 1 : 0;
+}
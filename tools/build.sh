@@ -0,0 +1,7 @@
+#!/bin/bash
+# Builds every tool in tools/ into build/
+
+mkdir -p build
+for source in tools/*.cpp; do
+    g++ -std=c++17 -O2 -march=native -pthread -Isrc "$source" -o "build/$( basename "$source" .cpp )" || exit 1
+done
@@ -0,0 +1,115 @@
+// ============================================================================
+// Copy-Make vs Make/Unmake Benchmark
+// ============================================================================
+// Perft and fixed-depth searches run both ways: make/unmake on one board,
+// and copy-make into a ply-indexed array of boards. Both must agree on
+// every count and best move; only the speed should differ.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -Isrc tools/copy_make_bench.cpp -o build/copy_make_bench
+//   ./build/copy_make_bench [perft depth] [search depth]
+
+#include "board.h"
+#include "game_state.h"
+#include "search.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static const char *POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+static long long PerftMakeUnmake( Board &board, int depth ) {
+    std::vector<Move> moves;
+    GameState::GenerateAllLegalMoves( board, moves, board.whiteToMove );
+    if ( depth == 1 )
+        return static_cast<long long>( moves.size() );
+
+    long long nodes = 0;
+    for ( Move &move : moves ) {
+        board.MakeMove( move );
+        nodes += PerftMakeUnmake( board, depth - 1 );
+        board.UndoMove( move );
+    }
+    return nodes;
+}
+
+static long long PerftCopyMake( Board *stack, int ply, int depth ) {
+    std::vector<Move> moves;
+    GameState::GenerateAllLegalMoves( stack[ply], moves, stack[ply].whiteToMove );
+    if ( depth == 1 )
+        return static_cast<long long>( moves.size() );
+
+    long long nodes = 0;
+    for ( Move &move : moves ) {
+        stack[ply + 1] = stack[ply];
+        stack[ply + 1].MakeMove( move );
+        nodes += PerftCopyMake( stack, ply + 1, depth - 1 );
+    }
+    return nodes;
+}
+
+static Board FromFEN( const char *fen ) {
+    Board board; // Empty: LoadFEN adds pieces to whatever is on the board
+    board.LoadFEN( fen );
+    return board;
+}
+
+template <typename Fn> static double Seconds( Fn fn ) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+int main( int argc, char **argv ) {
+    int perftDepth = argc > 1 ? atoi( argv[1] ) : 4;
+    int searchDepth = argc > 2 ? atoi( argv[2] ) : 4;
+    printf( "sizeof(Board) = %zu bytes\n\n", sizeof( Board ) );
+
+    long long unmakeNodes = 0, copyNodes = 0;
+    double unmakeTime = 0, copyTime = 0;
+    for ( const char *fen : POSITIONS ) {
+        Board board = FromFEN( fen );
+
+        std::vector<Board> stack( perftDepth + 1 );
+        stack[0] = board;
+        unmakeTime += Seconds( [&] { unmakeNodes += PerftMakeUnmake( board, perftDepth ); } );
+        copyTime += Seconds( [&] { copyNodes += PerftCopyMake( stack.data(), 0, perftDepth ); } );
+    }
+    printf( "perft %d      make/unmake %lld nodes %6.2fM nps   copy-make %lld nodes %6.2fM nps\n", perftDepth,
+            unmakeNodes, unmakeNodes / unmakeTime / 1e6, copyNodes, copyNodes / copyTime / 1e6 );
+
+    // The search prints its progress; keep the table readable
+    std::cout.setstate( std::ios::failbit );
+    long long searchNodes[2] = { 0, 0 };
+    double searchTime[2] = { 0, 0 };
+    int disagreements = 0;
+    for ( const char *fen : POSITIONS ) {
+        SearchEngine::SearchResult results[2];
+        for ( int mode = 0; mode < 2; mode++ ) {
+            Board board = FromFEN( fen );
+            SearchEngine::EvalTable().Clear();
+
+            SearchEngine engine;
+            engine.copyMake = mode == 1;
+            searchTime[mode] += Seconds( [&] { results[mode] = engine.FindBestMove( board, searchDepth ); } );
+            searchNodes[mode] += results[mode].nodesSearched;
+        }
+        disagreements += results[0].score != results[1].score ||
+                         results[0].bestMove.fromSquare != results[1].bestMove.fromSquare ||
+                         results[0].bestMove.toSquare != results[1].bestMove.toSquare;
+    }
+    std::cout.clear();
+    printf( "search %d     make/unmake %lld nodes %6.2fk nps   copy-make %lld nodes %6.2fk nps\n", searchDepth,
+            searchNodes[0], searchNodes[0] / searchTime[0] / 1e3, searchNodes[1],
+            searchNodes[1] / searchTime[1] / 1e3 );
+    printf( "disagreements: %d%s\n", disagreements,
+            unmakeNodes == copyNodes && searchNodes[0] == searchNodes[1] ? "" : " (node counts differ!)" );
+    return disagreements == 0 && unmakeNodes == copyNodes && searchNodes[0] == searchNodes[1] ? 0 : 1;
+}
@@ -0,0 +1,313 @@
+// ============================================================================
+// EPD Test-Suite Runner
+// ============================================================================
+// Searches every position of an EPD file (WAC, ECM, STS-style suites) under
+// a time, node or depth limit and checks the result against the "bm" (best
+// move) and "am" (avoid move) opcodes; "id" names the position. Positions
+// are spread over a pool of worker threads with one SearchEngine and one
+// transposition table each.
+//
+// A position counts as solved when the final move is a bm move and not an
+// am move. Its time to solution is when the search first settled on a
+// solving move and kept it through every later iteration.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/epd.cpp -o build/epd
+//   ./build/epd SUITE.epd [--movetime MS] [--nodes N] [--depth N] [--threads N] [--hash MB]
+
+#include "bitbase.h"
+#include "board.h"
+#include "notation.h"
+#include "search.h"
+#include "tt.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// ============================================================================
+// EPD Parsing
+// ============================================================================
+
+struct EpdPosition {
+    int line = 0;
+    std::string fen;
+    std::string id;
+    std::vector<std::string> bestText, avoidText; // As written in the file
+    std::vector<Move> best, avoid;
+};
+
+static std::string Trim( const std::string &text ) {
+    size_t first = text.find_first_not_of( " \t\r\n" );
+    size_t last = text.find_last_not_of( " \t\r\n" );
+    return first == std::string::npos ? "" : text.substr( first, last - first + 1 );
+}
+
+// Four position fields, then "opcode operands;" operations. hmvc and fmvn
+// fill in the FEN's move counters. False for a position LoadCheckedFen
+// rejects or a line without usable bm/am moves.
+static bool ParseEpd( const std::string &line, EpdPosition &position ) {
+    std::istringstream in( line );
+    std::string fields[4];
+    for ( std::string &field : fields ) {
+        if ( !( in >> field ) )
+            return false;
+    }
+
+    std::string rest, halfmove = "0", fullmove = "1";
+    std::getline( in, rest );
+    std::istringstream operations( rest );
+    for ( std::string operation; std::getline( operations, operation, ';' ); ) {
+        std::istringstream op( Trim( operation ) );
+        std::string opcode, operand;
+        op >> opcode;
+        std::vector<std::string> operands;
+        while ( op >> operand )
+            operands.push_back( operand );
+
+        if ( opcode == "bm" ) {
+            position.bestText = operands;
+        } else if ( opcode == "am" ) {
+            position.avoidText = operands;
+        } else if ( opcode == "id" ) {
+            position.id = Trim( Trim( operation ).substr( 2 ) );
+            position.id.erase( std::remove( position.id.begin(), position.id.end(), '"' ), position.id.end() );
+        } else if ( opcode == "hmvc" && !operands.empty() ) {
+            halfmove = operands[0];
+        } else if ( opcode == "fmvn" && !operands.empty() ) {
+            fullmove = operands[0];
+        }
+    }
+
+    position.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " " + halfmove + " " + fullmove;
+    Board board;
+    if ( !LoadCheckedFen( board, position.fen ) )
+        return false;
+    for ( auto [texts, moves] : { std::make_pair( &position.bestText, &position.best ),
+                                  std::make_pair( &position.avoidText, &position.avoid ) } ) {
+        for ( const std::string &text : *texts ) {
+            Move move( 0, 0 );
+            if ( !ParseSan( board, text, move ) )
+                return false;
+            moves->push_back( move );
+        }
+    }
+    return !position.best.empty() || !position.avoid.empty();
+}
+
+static bool SameMove( const Move &a, const Move &b ) {
+    return a.fromSquare == b.fromSquare && a.toSquare == b.toSquare && a.promotedPiece == b.promotedPiece;
+}
+
+static bool Solves( const EpdPosition &position, const Move &move ) {
+    auto matches = [&move]( const std::vector<Move> &moves ) {
+        return std::any_of( moves.begin(), moves.end(), [&move]( const Move &m ) { return SameMove( m, move ); } );
+    };
+    return ( position.best.empty() || matches( position.best ) ) && !matches( position.avoid );
+}
+
+// ============================================================================
+// Runner
+// ============================================================================
+
+struct Options {
+    std::string path;
+    SearchEngine::SearchLimits limits;
+    int threads = 1;
+    size_t hashMb = TranspositionTable::DEFAULT_MB;
+};
+
+struct Outcome {
+    bool solved = false;
+    double solvedAfter = 0; // Seconds
+    double seconds = 0;
+    uint64_t nodes = 0;
+    int depth = 0;
+    std::string found;
+};
+
+class SuiteRunner {
+  public:
+    SuiteRunner( const Options &options, std::vector<EpdPosition> &positions )
+        : options( options ), positions( positions ), outcomes( positions.size() ) {}
+
+    void Run() {
+        auto start = Clock::now();
+        std::vector<std::thread> workers;
+        for ( int i = 0; i < options.threads; i++ )
+            workers.emplace_back( [this] { WorkerLoop(); } );
+        for ( auto &worker : workers )
+            worker.join();
+        double wall = std::chrono::duration<double>( Clock::now() - start ).count();
+        Summarize( wall );
+    }
+
+  private:
+    const Options &options;
+    std::vector<EpdPosition> &positions;
+    std::vector<Outcome> outcomes;
+    std::atomic<size_t> next{ 0 };
+    std::mutex outputMutex;
+
+    void WorkerLoop() {
+        SearchEngine engine;
+        TranspositionTable tt( options.hashMb );
+        engine.verbose = false;
+        engine.tt = &tt;
+
+        for ( size_t index; ( index = next.fetch_add( 1 ) ) < positions.size(); ) {
+            const EpdPosition &position = positions[index];
+            Outcome &outcome = outcomes[index];
+            Board board;
+            LoadCheckedFen( board, position.fen ); // Checked by ParseEpd; drops castling rights without a rook
+            tt.Clear();
+
+            // Time to solution: reset whenever an iteration moves off the solution
+            auto start = Clock::now();
+            double settledAt = -1;
+            auto onIteration = [&]( const SearchEngine::SearchResult &result ) {
+                bool solving = Solves( position, result.bestMove );
+                if ( solving && settledAt < 0 )
+                    settledAt = std::chrono::duration<double>( Clock::now() - start ).count();
+                else if ( !solving )
+                    settledAt = -1;
+            };
+            engine.stop.store( false );
+            SearchEngine::SearchResult result = engine.Think( board, options.limits, onIteration );
+            outcome.seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+
+            outcome.nodes = result.nodesSearched;
+            outcome.depth = result.depth;
+            outcome.solved = !result.pv.empty() && Solves( position, result.bestMove );
+            outcome.solvedAfter = settledAt >= 0 ? settledAt : outcome.seconds; // Solved by a stopped iteration
+            outcome.found = result.pv.empty() ? "(none)" : ToSan( board, result.bestMove );
+            Report( position, outcome );
+        }
+    }
+
+    void Report( const EpdPosition &position, const Outcome &outcome ) {
+        std::string expected;
+        for ( const std::string &text : position.bestText )
+            expected += ( expected.empty() ? "bm " : " " ) + text;
+        for ( const std::string &text : position.avoidText )
+            expected += ( expected.empty() ? "am " : " am " ) + text;
+
+        std::lock_guard<std::mutex> lock( outputMutex );
+        printf( "%-12s %-8s %-14s found %-8s depth %2d %9llu nodes %8.0f ms", position.id.c_str(),
+                outcome.solved ? "solved" : "FAILED", expected.c_str(), outcome.found.c_str(), outcome.depth,
+                static_cast<unsigned long long>( outcome.nodes ), outcome.seconds * 1000 );
+        if ( outcome.solved )
+            printf( "  (at %.0f ms)", outcome.solvedAfter * 1000 );
+        printf( "\n" );
+        fflush( stdout );
+    }
+
+    void Summarize( double wall ) {
+        int solved = 0;
+        uint64_t nodes = 0;
+        double searchSeconds = 0, solveSeconds = 0;
+        for ( const Outcome &outcome : outcomes ) {
+            nodes += outcome.nodes;
+            searchSeconds += outcome.seconds;
+            if ( outcome.solved ) {
+                solved++;
+                solveSeconds += outcome.solvedAfter;
+            }
+        }
+
+        printf( "\nSolved %d/%zu (%.1f%%)\n", solved, positions.size(), 100.0 * solved / positions.size() );
+        if ( solved )
+            printf( "Mean time to solution %.0f ms\n", 1000 * solveSeconds / solved );
+        printf( "Nodes %llu, %.0f nps per thread, %.0f nps aggregate over %d threads\n",
+                static_cast<unsigned long long>( nodes ), nodes / std::max( searchSeconds, 1e-9 ),
+                nodes / std::max( wall, 1e-9 ), options.threads );
+        printf( "Wall time %.1f s\n", wall );
+
+        if ( solved < static_cast<int>( positions.size() ) ) {
+            printf( "Failed:" );
+            for ( size_t i = 0; i < positions.size(); i++ ) {
+                if ( !outcomes[i].solved )
+                    printf( " %s", positions[i].id.c_str() );
+            }
+            printf( "\n" );
+        }
+    }
+};
+
+int main( int argc, char **argv ) {
+    Options options;
+    options.threads = std::max( 1u, std::thread::hardware_concurrency() );
+    bool limited = false;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ( arg == "--movetime" && hasValue ) {
+            options.limits.milliseconds = atoll( argv[++i] );
+            limited = true;
+        } else if ( arg == "--nodes" && hasValue ) {
+            options.limits.nodes = strtoull( argv[++i], nullptr, 10 );
+            limited = true;
+        } else if ( arg == "--depth" && hasValue ) {
+            options.limits.depth = std::clamp( atoi( argv[++i] ), 1, SearchEngine::MAX_DEPTH );
+            limited = true;
+        } else if ( arg == "--threads" && hasValue ) {
+            options.threads = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--hash" && hasValue ) {
+            options.hashMb = std::max<size_t>( 1, strtoull( argv[++i], nullptr, 10 ) );
+        } else if ( options.path.empty() && arg[0] != '-' ) {
+            options.path = arg;
+        } else {
+            fprintf( stderr, "Unknown or incomplete option: %s\n", arg.c_str() );
+            return 1;
+        }
+    }
+    if ( options.path.empty() ) {
+        fprintf( stderr, "Usage: %s SUITE.epd [--movetime MS] [--nodes N] [--depth N] [--threads N] [--hash MB]\n",
+                 argv[0] );
+        return 1;
+    }
+    if ( !limited )
+        options.limits.milliseconds = 1000;
+
+    std::ifstream file( options.path );
+    if ( !file ) {
+        fprintf( stderr, "Cannot open %s\n", options.path.c_str() );
+        return 1;
+    }
+    std::vector<EpdPosition> positions;
+    int lineNumber = 0;
+    for ( std::string line; std::getline( file, line ); ) {
+        lineNumber++;
+        if ( Trim( line ).empty() || line[0] == '#' )
+            continue;
+        EpdPosition position;
+        position.line = lineNumber;
+        if ( !ParseEpd( line, position ) ) {
+            fprintf( stderr, "Line %d skipped: bad position or no usable bm/am moves\n", lineNumber );
+            continue;
+        }
+        if ( position.id.empty() )
+            position.id = "line " + std::to_string( lineNumber );
+        positions.push_back( position );
+    }
+    if ( positions.empty() ) {
+        fprintf( stderr, "No positions in %s\n", options.path.c_str() );
+        return 1;
+    }
+
+    printf( "%zu positions from %s, %d threads\n\n", positions.size(), options.path.c_str(), options.threads );
+    Bitbases::Init();
+    SuiteRunner runner( options, positions );
+    runner.Run();
+    return 0;
+}
@@ -0,0 +1,151 @@
+// ============================================================================
+// Evaluation Micro-Benchmark
+// ============================================================================
+// Evaluations per second for the classic evaluator, the NNUE evaluator and
+// the batch static-terms API, over positions from seeded random playouts.
+// No trained network ships, so the NNUE side runs a random network of the
+// real size: the speed is representative, the scores are not.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -Isrc tools/eval_bench.cpp -o build/eval_bench
+//   ./build/eval_bench [positions] [passes]
+
+#include "batch_eval.h"
+#include "board.h"
+#include "evaluate.h"
+#include "game_state.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static std::vector<Board> CollectPositions( int count ) {
+    std::vector<Board> positions;
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    Board board;
+    board.Reset();
+    int plies = 0;
+
+    while ( static_cast<int>( positions.size() ) < count ) {
+        std::vector<Move> moves;
+        GameState::GenerateAllLegalMoves( board, moves, board.whiteToMove );
+        if ( moves.empty() || plies >= 120 ) {
+            board.Reset();
+            plies = 0;
+            continue;
+        }
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        board.MakeMove( moves[seed % moves.size()] );
+        plies++;
+        positions.push_back( board );
+    }
+    return positions;
+}
+
+// Runs fn over every position `passes` times; returns evaluations per second
+template <typename Fn> static double Measure( std::vector<Board> &positions, int passes, Fn fn, long long &checksum ) {
+    auto start = std::chrono::steady_clock::now();
+    for ( int pass = 0; pass < passes; pass++ ) {
+        for ( Board &board : positions ) {
+            checksum += fn( board );
+        }
+    }
+    double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    return positions.size() * static_cast<double>( passes ) / seconds;
+}
+
+int main( int argc, char **argv ) {
+    int count = argc > 1 ? atoi( argv[1] ) : 20000;
+    int passes = argc > 2 ? atoi( argv[2] ) : 5;
+
+#if defined( __AVX2__ )
+    printf( "NNUE kernels: AVX2\n" );
+#else
+    printf( "NNUE kernels: scalar\n" );
+#endif
+
+    NNUE::InitRandom( 1 );
+    std::vector<Board> positions = CollectPositions( count );
+    long long checksum = 0;
+
+    NNUE::SetEnabled( false );
+    double classic = Measure( positions, passes, []( Board &b ) { return Evaluator::Evaluate( b ); }, checksum );
+
+    // Evaluate outside a search builds the accumulator from scratch
+    NNUE::SetEnabled( true );
+    double refresh = Measure( positions, 1, []( Board &b ) { return NNUE::Evaluate( b ); }, checksum );
+    double nnue = Measure( positions, passes, []( Board &b ) { return Evaluator::Evaluate( b ); }, checksum );
+
+    // Forward pass alone, over accumulators built beforehand
+    std::vector<NNUE::AccumulatorStack> roots( positions.size() );
+    for ( size_t i = 0; i < positions.size(); i++ ) {
+        roots[i].Reset( positions[i] );
+    }
+    auto start = std::chrono::steady_clock::now();
+    for ( int pass = 0; pass < passes; pass++ ) {
+        for ( size_t i = 0; i < positions.size(); i++ ) {
+            checksum += NNUE::Evaluate( roots[i], positions[i] );
+        }
+    }
+    double network = positions.size() * static_cast<double>( passes ) /
+                     std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    // Search-like pattern: make each legal move, push it on the accumulator
+    // stack, evaluate the child, pop and undo. Counts child evaluations, so
+    // this is the incremental update path.
+    long long children = 0;
+    NNUE::AccumulatorStack stack( 2 );
+    auto childEvals = [&children, &stack]( Board &b ) {
+        std::vector<Move> moves;
+        GameState::GenerateAllLegalMoves( b, moves, b.whiteToMove );
+        stack.Reset( b );
+        int sum = 0;
+        for ( Move &move : moves ) {
+            b.MakeMove( move );
+            stack.Push( b, move );
+            sum += NNUE::Evaluate( stack, b );
+            stack.Pop();
+            b.UndoMove( move );
+        }
+        children += moves.size();
+        return sum;
+    };
+    start = std::chrono::steady_clock::now();
+    Measure( positions, 1, childEvals, checksum );
+    double incremental = children / std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    // Static terms: one board at a time versus the structure-of-arrays batch
+    NNUE::SetEnabled( false );
+    double staticTerms =
+        Measure( positions, passes, []( Board &b ) { return Evaluator::EvaluateStaticTerms( b ); }, checksum );
+
+    BatchEval::PositionBlock block;
+    for ( const Board &board : positions ) {
+        block.Add( board );
+    }
+    std::vector<int> results( block.Size() );
+    start = std::chrono::steady_clock::now();
+    for ( int pass = 0; pass < passes; pass++ ) {
+        BatchEval::Evaluate( block, results.data() );
+    }
+    double batch = block.Size() * static_cast<double>( passes ) /
+                   std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    int mismatches = 0;
+    for ( size_t i = 0; i < positions.size(); i++ ) {
+        mismatches += results[i] != Evaluator::EvaluateStaticTerms( positions[i] );
+    }
+
+    printf( "Positions: %zu x %d passes\n", positions.size(), passes );
+    printf( "%-30s %12.0f evals/s\n", "Classic Evaluate:", classic );
+    printf( "%-30s %12.0f evals/s\n", "NNUE Evaluate:", nnue );
+    printf( "%-30s %12.0f evals/s\n", "NNUE forward pass only:", network );
+    printf( "%-30s %12.0f evals/s\n", "NNUE refresh + forward:", refresh );
+    printf( "%-30s %12.0f evals/s\n", "NNUE make + forward + undo:", incremental );
+    printf( "%-30s %12.0f evals/s\n", "Static terms, per board:", staticTerms );
+    printf( "%-30s %12.0f evals/s (%d mismatches)\n", "Static terms, batch:", batch, mismatches );
+    printf( "Checksum: %lld\n", checksum );
+    return 0;
+}
@@ -0,0 +1,252 @@
+// ============================================================================
+// Opening Book Builder
+// ============================================================================
+// Builds a book.h opening book from PGN games and EPD positions. Each
+// (position, move) pair is weighted from the mover's point of view: 2 for
+// a game the mover won, 1 for a draw or an unknown result, 0 for a loss.
+// An EPD line adds 1 for each of its "bm" moves. Pairs seen in fewer than
+// --min-games games and pairs with zero weight are dropped; weights are
+// scaled down to fit 16 bits when needed.
+//
+// The output uses the Polyglot layout but the engine's own Zobrist keys,
+// so it is only for this engine (see book.h).
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/make_book.cpp -o build/make_book
+//   ./build/make_book BOOK.bin INPUT.pgn|INPUT.epd... [--max-ply N] [--min-games N]
+//   ./build/make_book --show BOOK.bin [FEN]
+
+#include "board.h"
+#include "book.h"
+#include "notation.h"
+#include "pgn.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static constexpr int DEFAULT_MAX_PLY = 20;
+static constexpr size_t COMPACT_EVERY = 1 << 22; // Records between merges, bounds memory on big inputs
+
+// ============================================================================
+// Accumulation
+// ============================================================================
+
+struct Record {
+    uint64_t key;
+    uint16_t move;
+    uint32_t games;
+    uint64_t weight;
+};
+
+class BookBuilder {
+  public:
+    void Add( uint64_t key, uint16_t move, uint64_t weight ) {
+        records.push_back( { key, move, 1, weight } );
+        if ( records.size() >= compactAt ) {
+            Compact();
+            compactAt = std::max( COMPACT_EVERY, records.size() * 2 );
+        }
+    }
+
+    // Returns the number of entries written
+    size_t Write( const std::string &path, uint32_t minGames ) {
+        Compact();
+        std::vector<Record> kept;
+        uint64_t maxWeight = 0;
+        for ( const Record &record : records ) {
+            if ( record.games >= minGames && record.weight > 0 ) {
+                kept.push_back( record );
+                maxWeight = std::max( maxWeight, record.weight );
+            }
+        }
+        std::sort( kept.begin(), kept.end(), []( const Record &a, const Record &b ) {
+            return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+        } );
+
+        std::vector<uint8_t> bytes( kept.size() * OpeningBook::ENTRY_BYTES );
+        for ( size_t i = 0; i < kept.size(); i++ ) {
+            uint64_t weight = kept[i].weight;
+            if ( maxWeight > 0xFFFF )
+                weight = std::max<uint64_t>( 1, weight * 0xFFFF / maxWeight );
+            OpeningBook::Entry entry{ kept[i].key, kept[i].move, static_cast<uint16_t>( weight ), 0 };
+            OpeningBook::WriteEntry( entry, &bytes[i * OpeningBook::ENTRY_BYTES] );
+        }
+
+        std::ofstream out( path, std::ios::binary );
+        out.write( reinterpret_cast<const char *>( bytes.data() ), bytes.size() );
+        return out ? kept.size() : 0;
+    }
+
+  private:
+    std::vector<Record> records;
+    size_t compactAt = COMPACT_EVERY;
+
+    // Sorts by (key, move) and merges duplicates
+    void Compact() {
+        std::sort( records.begin(), records.end(), []( const Record &a, const Record &b ) {
+            return a.key != b.key ? a.key < b.key : a.move < b.move;
+        } );
+        size_t out = 0;
+        for ( size_t i = 0; i < records.size(); i++ ) {
+            if ( out > 0 && records[out - 1].key == records[i].key && records[out - 1].move == records[i].move ) {
+                records[out - 1].games += records[i].games;
+                records[out - 1].weight += records[i].weight;
+            } else {
+                records[out++] = records[i];
+            }
+        }
+        records.resize( out );
+    }
+};
+
+// ============================================================================
+// PGN Input
+// ============================================================================
+
+static size_t AddPgn( BookBuilder &builder, const std::string &path, int maxPly, size_t &positions ) {
+    Pgn::MappedFile file;
+    if ( !file.Open( path ) )
+        return 0;
+    Pgn::Reader reader( file.Text() );
+    Pgn::GameText game;
+    Board board;
+    size_t games = 0;
+    while ( reader.Next( game ) ) {
+        games++;
+        std::string_view result = game.TagValue( "Result" );
+        int whiteWeight = result == "1-0" ? 2 : result == "0-1" ? 0 : 1;
+        int ply = 0;
+        // An illegal or unreadable move ends the game; the plies before it are kept
+        Pgn::Replay( game, board, [&]( const Board &position, const Move &move ) {
+            if ( ply++ >= maxPly )
+                return false;
+            builder.Add( position.hashKey, OpeningBook::EncodeMove( move ),
+                         position.whiteToMove ? whiteWeight : 2 - whiteWeight );
+            positions++;
+            return true;
+        } );
+    }
+    return games;
+}
+
+// ============================================================================
+// EPD Input
+// ============================================================================
+
+static size_t AddEpd( BookBuilder &builder, const std::string &path, size_t &positions ) {
+    std::ifstream file( path );
+    size_t lines = 0;
+    for ( std::string line; std::getline( file, line ); ) {
+        std::istringstream in( line );
+        std::string fields[4];
+        if ( !( in >> fields[0] >> fields[1] >> fields[2] >> fields[3] ) )
+            continue;
+        size_t at = line.find( " bm " );
+        if ( at == std::string::npos )
+            continue;
+        lines++;
+
+        Board board;
+        board.LoadFEN( fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] );
+        std::istringstream moves( line.substr( at + 4, line.find( ';', at ) - at - 4 ) );
+        for ( std::string san; moves >> san; ) {
+            Move move( 0, 0 );
+            if ( ParseSan( board, san, move ) ) {
+                builder.Add( board.hashKey, OpeningBook::EncodeMove( move ), 1 );
+                positions++;
+            }
+        }
+    }
+    return lines;
+}
+
+// Lists the book moves for a position
+static int Show( const std::string &path, const std::string &fen ) {
+    OpeningBook book;
+    if ( !book.Open( path ) ) {
+        fprintf( stderr, "Cannot open book %s\n", path.c_str() );
+        return 1;
+    }
+    Board board;
+    if ( fen.empty() )
+        board.Reset();
+    else
+        board.LoadFEN( fen );
+
+    std::vector<OpeningBook::Entry> entries;
+    book.Lookup( board.hashKey, entries );
+    std::vector<Move> legal;
+    GameState::GenerateAllLegalMoves( board, legal, board.whiteToMove );
+    printf( "%zu entries in book, %zu for this position\n", book.Size(), entries.size() );
+    for ( const OpeningBook::Entry &entry : entries ) {
+        std::string name = "(not legal)";
+        for ( const Move &move : legal ) {
+            if ( OpeningBook::EncodeMove( move ) == entry.move )
+                name = ToSan( board, move );
+        }
+        printf( "  %-8s weight %u\n", name.c_str(), entry.weight );
+    }
+    return 0;
+}
+
+static bool EndsWith( const std::string &text, const std::string &suffix ) {
+    return text.size() >= suffix.size() && text.compare( text.size() - suffix.size(), suffix.size(), suffix ) == 0;
+}
+
+int main( int argc, char **argv ) {
+    if ( argc >= 3 && std::string( argv[1] ) == "--show" ) {
+        std::string fen;
+        for ( int i = 3; i < argc; i++ )
+            fen += ( fen.empty() ? "" : " " ) + std::string( argv[i] );
+        return Show( argv[2], fen );
+    }
+
+    std::string output;
+    std::vector<std::string> inputs;
+    int maxPly = DEFAULT_MAX_PLY;
+    uint32_t minGames = 1;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        if ( arg == "--max-ply" && i + 1 < argc ) {
+            maxPly = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--min-games" && i + 1 < argc ) {
+            minGames = static_cast<uint32_t>( std::max( 1, atoi( argv[++i] ) ) );
+        } else if ( arg[0] != '-' && output.empty() ) {
+            output = arg;
+        } else if ( arg[0] != '-' ) {
+            inputs.push_back( arg );
+        } else {
+            output.clear();
+            break;
+        }
+    }
+    if ( output.empty() || inputs.empty() ) {
+        fprintf( stderr,
+                 "Usage: %s BOOK.bin INPUT.pgn|INPUT.epd... [--max-ply N] [--min-games N]\n"
+                 "       %s --show BOOK.bin [FEN]\n",
+                 argv[0], argv[0] );
+        return 1;
+    }
+
+    BookBuilder builder;
+    size_t positions = 0;
+    for ( const std::string &input : inputs ) {
+        if ( !std::ifstream( input ) ) {
+            fprintf( stderr, "Cannot open %s\n", input.c_str() );
+            return 1;
+        }
+        if ( EndsWith( input, ".epd" ) )
+            printf( "%s: %zu positions\n", input.c_str(), AddEpd( builder, input, positions ) );
+        else
+            printf( "%s: %zu games\n", input.c_str(), AddPgn( builder, input, maxPly, positions ) );
+    }
+
+    size_t entries = builder.Write( output, minGames );
+    printf( "%zu moves read, %zu entries written to %s\n", positions, entries, output.c_str() );
+    return entries ? 0 : 1;
+}
@@ -0,0 +1,511 @@
+// ============================================================================
+// Engine Match Runner
+// ============================================================================
+// Plays games between two SearchEngine configurations, one game per worker
+// thread, and can stop early once a sequential probability ratio test
+// (SPRT) decides. Each opening is played twice with colours swapped. Games
+// go to a PGN file; the summary gives W/D/L from engine 1's side, an Elo
+// estimate, the LLR, games per hour and core utilisation.
+//
+// Engine specs are comma-separated key=value pairs; an engine given no
+// depth, nodes or movetime searches to depth 3:
+//   name=NAME, depth=N, nodes=N, movetime=MS, hash=MB (0 = no table), copymake=0|1
+//
+// Openings are one per line: a FEN (EPD works; missing fields default) or
+// UCI moves from the start position. '#' starts a comment.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/match.cpp -o build/match
+//   ./build/match --engine1 name=new,depth=4 --engine2 name=base,depth=3 [--games N]
+//       [--concurrency N] [--openings FILE] [--pgn FILE] [--sprt ELO0 ELO1] [--max-plies N]
+//       [--adjudicate-score CP] [--adjudicate-material CP] [--adjudicate-plies N]
+
+#include "bitbase.h"
+#include "board.h"
+#include "evaluate.h"
+#include "game_state.h"
+#include "material.h"
+#include "notation.h"
+#include "pgn.h"
+#include "search.h"
+#include "tt.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+// Used when no --openings file is given: common first moves, balanced enough
+// that both colours have a game
+static const char *DEFAULT_OPENINGS[] = {
+    "e2e4 e7e5 g1f3 b8c6 f1b5 a7a6", "e2e4 e7e5 g1f3 b8c6 f1c4 f8c5", "e2e4 c7c5 g1f3 d7d6 d2d4 c5d4",
+    "e2e4 c7c5 b1c3 b8c6",           "e2e4 e7e6 d2d4 d7d5",           "e2e4 c7c6 d2d4 d7d5",
+    "e2e4 d7d5 e4d5 d8d5",           "e2e4 g7g6 d2d4 f8g7",           "e2e4 e7e5 f2f4 e5f4",
+    "d2d4 d7d5 c2c4 e7e6",           "d2d4 d7d5 c2c4 c7c6",           "d2d4 g8f6 c2c4 g7g6 b1c3 f8g7",
+    "d2d4 g8f6 c2c4 e7e6 b1c3 f8b4", "d2d4 f7f5 g2g3 g8f6",           "c2c4 e7e5 b1c3 g8f6",
+    "g1f3 d7d5 g2g3 g8f6",
+};
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+struct EngineConfig {
+    std::string name;
+    SearchEngine::SearchLimits limits;
+    size_t hashMb = TranspositionTable::DEFAULT_MB;
+    bool copyMake = false;
+};
+
+struct MatchConfig {
+    EngineConfig engines[2];
+    int games = 100;
+    int concurrency = 1;
+    int maxPlies = 400;
+    int adjudicateScore = 1000;   // Both sides' searches agree on at least this, in centipawns
+    int adjudicateMaterial = 900; // Or one side is this far ahead in material
+    int adjudicatePlies = 8;      // For this many plies in a row
+    bool sprt = false;
+    double elo0 = 0, elo1 = 10, alpha = 0.05, beta = 0.05;
+    std::string openingsPath;
+    std::string pgnPath = "match.pgn";
+};
+
+static bool ParseEngine( const std::string &spec, EngineConfig &config ) {
+    std::istringstream in( spec );
+    std::string pair;
+    while ( std::getline( in, pair, ',' ) ) {
+        size_t equals = pair.find( '=' );
+        if ( equals == std::string::npos )
+            return false;
+        std::string key = pair.substr( 0, equals ), value = pair.substr( equals + 1 );
+        if ( key == "name" ) {
+            config.name = value;
+        } else if ( key == "depth" ) {
+            config.limits.depth = std::clamp( atoi( value.c_str() ), 1, SearchEngine::MAX_DEPTH );
+        } else if ( key == "nodes" ) {
+            config.limits.nodes = strtoull( value.c_str(), nullptr, 10 );
+        } else if ( key == "movetime" ) {
+            config.limits.milliseconds = atoll( value.c_str() );
+        } else if ( key == "hash" ) {
+            config.hashMb = strtoull( value.c_str(), nullptr, 10 );
+        } else if ( key == "copymake" ) {
+            config.copyMake = value != "0";
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Openings
+// ============================================================================
+
+struct Opening {
+    std::string fen; // Empty for the start position
+    std::vector<std::string> moves;
+};
+
+static std::vector<Opening> LoadOpenings( const std::string &path ) {
+    std::vector<std::string> lines;
+    if ( path.empty() ) {
+        lines.assign( std::begin( DEFAULT_OPENINGS ), std::end( DEFAULT_OPENINGS ) );
+    } else {
+        std::ifstream file( path );
+        for ( std::string line; std::getline( file, line ); )
+            lines.push_back( line.substr( 0, line.find( '#' ) ) );
+    }
+
+    std::vector<Opening> openings;
+    for ( const std::string &line : lines ) {
+        std::istringstream in( line );
+        std::vector<std::string> tokens;
+        for ( std::string token; in >> token; )
+            tokens.push_back( token );
+        if ( tokens.empty() )
+            continue;
+
+        Opening opening;
+        if ( tokens[0].find( '/' ) != std::string::npos ) {
+            // FEN or EPD: keep the position fields, drop EPD opcodes
+            static const char *DEFAULTS[] = { "", "w", "-", "-", "0", "1" };
+            for ( size_t i = 0; i < 6; i++ ) {
+                bool present = i < tokens.size() && ( i < 4 || isdigit( tokens[i][0] ) );
+                opening.fen += ( i ? " " : "" ) + ( present ? tokens[i] : std::string( DEFAULTS[i] ) );
+            }
+        } else {
+            opening.moves = tokens;
+        }
+        openings.push_back( opening );
+    }
+    return openings;
+}
+
+// ============================================================================
+// Playing a Game
+// ============================================================================
+
+struct GameRecord {
+    int round = 0;
+    bool engine1White = true;
+    std::string startFen; // Empty for the start position
+    int firstMoveNumber = 1;
+    bool blackMovesFirst = false;
+    std::vector<std::string> san;
+    std::string result = "*";
+    std::string reason;
+    bool adjudicated = false;
+};
+
+// One SearchEngine per configuration, reused for every game a worker plays
+struct Player {
+    const EngineConfig *config = nullptr;
+    SearchEngine engine;
+    std::unique_ptr<TranspositionTable> tt;
+};
+
+static int MaterialBalance( const Board &board ) {
+    int balance = 0;
+    for ( int piece = WP; piece < WK; piece++ ) {
+        balance += Evaluator::PIECE_VALUES[piece] * ( __builtin_popcountll( board.bitboards[piece] ) -
+                                                     __builtin_popcountll( board.bitboards[piece + 6] ) );
+    }
+    return balance;
+}
+
+// Counts plies in a row where value passes the threshold with the same sign
+struct Streak {
+    int plies = 0;
+    int sign = 0;
+
+    bool Update( int value, int threshold, int needed ) {
+        int current = value >= threshold ? 1 : value <= -threshold ? -1 : 0;
+        if ( current == 0 )
+            plies = 0;
+        else
+            plies = current == sign ? plies + 1 : 1;
+        sign = current;
+        return plies >= needed;
+    }
+};
+
+static void PlayGame( const MatchConfig &config, const Opening &opening, Player *players, GameRecord &game ) {
+    Board board;
+    if ( opening.fen.empty() ) {
+        board.Reset();
+    } else {
+        board.LoadFEN( opening.fen );
+        game.startFen = opening.fen;
+        game.firstMoveNumber = std::max( 1, atoi( opening.fen.substr( opening.fen.rfind( ' ' ) + 1 ).c_str() ) );
+        game.blackMovesFirst = !board.whiteToMove;
+    }
+
+    std::vector<uint64_t> history{ board.hashKey }; // Positions since the last pawn move or capture
+    auto play = [&]( Move move ) {
+        game.san.push_back( ToSan( board, move ) );
+        bool irreversible = move.isCapture || board.mailbox[move.fromSquare] % 6 == WP;
+        board.MakeMove( move );
+        if ( irreversible )
+            history.clear();
+        history.push_back( board.hashKey );
+    };
+    auto finish = [&]( const char *result, const char *reason, bool adjudicated ) {
+        game.result = result;
+        game.reason = reason;
+        game.adjudicated = adjudicated;
+    };
+
+    for ( const std::string &text : opening.moves ) {
+        Move move( 0, 0 );
+        if ( !ParseUci( board, text, move ) )
+            break; // Play on from the last legal position
+        play( move );
+    }
+
+    for ( int i = 0; i < 2; i++ ) {
+        if ( players[i].tt )
+            players[i].tt->Clear();
+    }
+
+    Streak scoreStreak, materialStreak;
+    for ( int ply = 0;; ply++ ) {
+        std::vector<Move> legal;
+        GameState::GenerateAllLegalMoves( board, legal, board.whiteToMove );
+        if ( legal.empty() && GameState::IsKingInCheck( board, board.whiteToMove ) )
+            return finish( board.whiteToMove ? "0-1" : "1-0", "checkmate", false );
+        if ( legal.empty() )
+            return finish( "1/2-1/2", "stalemate", false );
+        if ( history.size() > 100 )
+            return finish( "1/2-1/2", "fifty-move rule", false );
+        if ( std::count( history.begin(), history.end(), board.hashKey ) >= 3 )
+            return finish( "1/2-1/2", "threefold repetition", false );
+        if ( Evaluator::IsInsufficientMaterial( board, MaterialTable::Probe( board ) ) )
+            return finish( "1/2-1/2", "insufficient material", false );
+        if ( ply >= config.maxPlies )
+            return finish( "1/2-1/2", "move limit", true );
+
+        Player &player = players[board.whiteToMove == game.engine1White ? 0 : 1];
+        player.engine.stop.store( false );
+        SearchEngine::SearchResult result = player.engine.Think( board, player.config->limits );
+        if ( result.pv.empty() )
+            result.bestMove = legal[0]; // A limit too tight for even one root move
+
+        // Scores are from White's side, so consecutive plies from both engines agree in sign
+        if ( scoreStreak.Update( result.score, config.adjudicateScore, config.adjudicatePlies ) )
+            return finish( scoreStreak.sign > 0 ? "1-0" : "0-1", "score adjudication", true );
+        if ( materialStreak.Update( MaterialBalance( board ), config.adjudicateMaterial, config.adjudicatePlies ) )
+            return finish( materialStreak.sign > 0 ? "1-0" : "0-1", "material adjudication", true );
+
+        play( result.bestMove );
+    }
+}
+
+// ============================================================================
+// PGN
+// ============================================================================
+
+static std::string ToPgn( const MatchConfig &config, const GameRecord &game, const std::string &date ) {
+    const EngineConfig &white = config.engines[game.engine1White ? 0 : 1];
+    const EngineConfig &black = config.engines[game.engine1White ? 1 : 0];
+
+    std::ostringstream pgn;
+    pgn << "[Event \"Engine match\"]\n[Site \"?\"]\n[Date \"" << date << "\"]\n[Round \"" << game.round << "\"]\n";
+    pgn << "[White \"" << white.name << "\"]\n[Black \"" << black.name << "\"]\n[Result \"" << game.result << "\"]\n";
+    if ( !game.startFen.empty() )
+        pgn << "[SetUp \"1\"]\n[FEN \"" << game.startFen << "\"]\n";
+    pgn << "[PlyCount \"" << game.san.size() << "\"]\n";
+    pgn << "[Termination \"" << ( game.adjudicated ? "adjudication" : "normal" ) << "\"]\n\n";
+
+    std::string movetext;
+    Pgn::MovetextWriter writer( movetext, game.firstMoveNumber, !game.blackMovesFirst );
+    for ( const std::string &san : game.san )
+        writer.AddSan( san );
+    writer.Token( "{" + game.reason + "}" );
+    writer.Token( game.result );
+    writer.Finish();
+    pgn << movetext << '\n';
+    return pgn.str();
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+static double ExpectedScore( double elo ) { return 1 / ( 1 + std::pow( 10.0, -elo / 400 ) ); }
+
+static double Elo( double score ) {
+    score = std::clamp( score, 1e-6, 1 - 1e-6 );
+    return -400 * std::log10( 1 / score - 1 );
+}
+
+struct Tally {
+    int wins = 0, draws = 0, losses = 0; // Engine 1's
+
+    int Games() const { return wins + draws + losses; }
+    double Score() const { return Games() ? ( wins + 0.5 * draws ) / Games() : 0.5; }
+
+    // Per-game variance of engine 1's score
+    double Variance() const {
+        if ( Games() == 0 )
+            return 0;
+        double score = Score();
+        return ( wins * std::pow( 1 - score, 2 ) + draws * std::pow( 0.5 - score, 2 ) + losses * score * score ) /
+               Games();
+    }
+
+    // Log-likelihood ratio of elo1 against elo0, normal approximation to
+    // the trinomial model
+    double LLR( double elo0, double elo1 ) const {
+        double variance = Variance();
+        if ( variance <= 0 )
+            return 0;
+        double score0 = ExpectedScore( elo0 ), score1 = ExpectedScore( elo1 );
+        return ( score1 - score0 ) * ( 2 * Score() - score0 - score1 ) / ( 2 * variance / Games() );
+    }
+};
+
+// ============================================================================
+// Match
+// ============================================================================
+
+class Match {
+  public:
+    explicit Match( const MatchConfig &config ) : config( config ), openings( LoadOpenings( config.openingsPath ) ) {}
+
+    int Run() {
+        if ( openings.empty() ) {
+            fprintf( stderr, "No openings\n" );
+            return 1;
+        }
+        pgnFile.open( config.pgnPath );
+        char buffer[16];
+        time_t now = time( nullptr );
+        strftime( buffer, sizeof( buffer ), "%Y.%m.%d", localtime( &now ) );
+        date = buffer;
+
+        printf( "%s vs %s: %d games, %zu openings, %d concurrent\n", config.engines[0].name.c_str(),
+                config.engines[1].name.c_str(), config.games, openings.size(), config.concurrency );
+        if ( config.sprt ) {
+            printf( "SPRT elo0 %.1f elo1 %.1f alpha %.2f beta %.2f: bounds [%.2f, %.2f]\n", config.elo0, config.elo1,
+                    config.alpha, config.beta, LowerBound(), UpperBound() );
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for ( int i = 0; i < config.concurrency; i++ )
+            workers.emplace_back( [this] { WorkerLoop(); } );
+        for ( auto &worker : workers )
+            worker.join();
+        double wall = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        rusage usage;
+        getrusage( RUSAGE_SELF, &usage );
+        double cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec +
+                     usage.ru_stime.tv_usec / 1e6;
+
+        int games = tally.Games();
+        double margin = 1.96 * std::sqrt( tally.Variance() / std::max( games, 1 ) );
+        printf( "\n%s vs %s: +%d =%d -%d (%d games), score %.1f%%\n", config.engines[0].name.c_str(),
+                config.engines[1].name.c_str(), tally.wins, tally.draws, tally.losses, games, 100 * tally.Score() );
+        printf( "Elo %+.1f [%+.1f, %+.1f] (95%%)\n", Elo( tally.Score() ), Elo( tally.Score() - margin ),
+                Elo( tally.Score() + margin ) );
+        if ( config.sprt ) {
+            double llr = tally.LLR( config.elo0, config.elo1 );
+            const char *verdict = llr >= UpperBound()   ? "H1 accepted"
+                                  : llr <= LowerBound() ? "H0 accepted"
+                                                        : "undecided";
+            printf( "SPRT LLR %.2f [%.2f, %.2f]: %s\n", llr, LowerBound(), UpperBound(), verdict );
+        }
+        printf( "%.1f s wall, %.0f games/hour, core utilisation %.0f%% of %d workers (%u hardware threads)\n", wall,
+                games * 3600 / wall, 100 * cpu / ( wall * config.concurrency ), config.concurrency,
+                std::thread::hardware_concurrency() );
+        printf( "PGN written to %s\n", config.pgnPath.c_str() );
+        return 0;
+    }
+
+  private:
+    const MatchConfig &config;
+    std::vector<Opening> openings;
+    std::atomic<int> nextGame{ 0 };
+    std::atomic<bool> decided{ false }; // SPRT finished; no new games start
+
+    std::mutex resultsMutex; // Guards everything below
+    Tally tally;
+    std::ofstream pgnFile;
+    std::string date;
+
+    double LowerBound() const { return std::log( config.beta / ( 1 - config.alpha ) ); }
+    double UpperBound() const { return std::log( ( 1 - config.beta ) / config.alpha ); }
+
+    void WorkerLoop() {
+        Player players[2];
+        for ( int i = 0; i < 2; i++ ) {
+            players[i].config = &config.engines[i];
+            players[i].engine.verbose = false;
+            players[i].engine.copyMake = config.engines[i].copyMake;
+            if ( config.engines[i].hashMb ) {
+                players[i].tt.reset( new TranspositionTable( config.engines[i].hashMb ) );
+                players[i].engine.tt = players[i].tt.get();
+            }
+        }
+
+        for ( ;; ) {
+            int index = nextGame.fetch_add( 1 );
+            if ( index >= config.games || decided.load() )
+                return;
+
+            GameRecord game;
+            game.round = index + 1;
+            game.engine1White = index % 2 == 0; // Each opening twice, colours swapped
+            PlayGame( config, openings[index / 2 % openings.size()], players, game );
+            Record( game );
+        }
+    }
+
+    void Record( const GameRecord &game ) {
+        std::lock_guard<std::mutex> lock( resultsMutex );
+        bool whiteWon = game.result == "1-0", blackWon = game.result == "0-1";
+        if ( whiteWon || blackWon )
+            ( whiteWon == game.engine1White ? tally.wins : tally.losses )++;
+        else
+            tally.draws++;
+        pgnFile << ToPgn( config, game, date ) << std::flush;
+
+        const EngineConfig &white = config.engines[game.engine1White ? 0 : 1];
+        const EngineConfig &black = config.engines[game.engine1White ? 1 : 0];
+        printf( "Game %d: %s vs %s %s (%s, %zu plies)  +%d =%d -%d", game.round, white.name.c_str(),
+                black.name.c_str(), game.result.c_str(), game.reason.c_str(), game.san.size(), tally.wins,
+                tally.draws, tally.losses );
+        if ( config.sprt ) {
+            double llr = tally.LLR( config.elo0, config.elo1 );
+            printf( "  LLR %.2f", llr );
+            if ( llr >= UpperBound() || llr <= LowerBound() )
+                decided.store( true );
+        }
+        printf( "\n" );
+        fflush( stdout );
+    }
+};
+
+int main( int argc, char **argv ) {
+    MatchConfig config;
+    config.engines[0].name = "engine1";
+    config.engines[1].name = "engine2";
+    config.concurrency = std::max( 1u, std::thread::hardware_concurrency() );
+
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ( ( arg == "--engine1" || arg == "--engine2" ) && hasValue ) {
+            if ( !ParseEngine( argv[++i], config.engines[arg == "--engine2"] ) ) {
+                fprintf( stderr, "Bad engine spec: %s\n", argv[i] );
+                return 1;
+            }
+        } else if ( arg == "--games" && hasValue ) {
+            config.games = atoi( argv[++i] );
+        } else if ( arg == "--concurrency" && hasValue ) {
+            config.concurrency = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--openings" && hasValue ) {
+            config.openingsPath = argv[++i];
+        } else if ( arg == "--pgn" && hasValue ) {
+            config.pgnPath = argv[++i];
+        } else if ( arg == "--max-plies" && hasValue ) {
+            config.maxPlies = atoi( argv[++i] );
+        } else if ( arg == "--adjudicate-score" && hasValue ) {
+            config.adjudicateScore = atoi( argv[++i] );
+        } else if ( arg == "--adjudicate-material" && hasValue ) {
+            config.adjudicateMaterial = atoi( argv[++i] );
+        } else if ( arg == "--adjudicate-plies" && hasValue ) {
+            config.adjudicatePlies = atoi( argv[++i] );
+        } else if ( arg == "--sprt" && i + 2 < argc ) {
+            config.sprt = true;
+            config.elo0 = atof( argv[++i] );
+            config.elo1 = atof( argv[++i] );
+        } else {
+            fprintf( stderr, "Unknown or incomplete option: %s\n", arg.c_str() );
+            return 1;
+        }
+    }
+
+    // An engine given no limit searches to depth 3
+    for ( EngineConfig &engine : config.engines ) {
+        const SearchEngine::SearchLimits &limits = engine.limits;
+        if ( limits.depth == SearchEngine::MAX_DEPTH && !limits.nodes && !limits.milliseconds )
+            engine.limits.depth = 3;
+    }
+
+    Bitbases::Init();
+    Match match( config );
+    return match.Run();
+}
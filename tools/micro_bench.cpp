@@ -0,0 +1,340 @@
+// ============================================================================
+// Hot-Path Micro-Benchmarks
+// ============================================================================
+// Times each primitive the search leans on in isolation, so a slowdown can
+// be pinned to one of them instead of showing up only in whole-search NPS.
+// The corpus is fixed: the bench positions plus seeded random playouts
+// from them.
+//
+// Every benchmark runs in batches of at least ~20 ms. The report gives the
+// median ns/op, the relative standard deviation across batches and the
+// fastest batch. With --perf it adds hardware counters per op (cycles,
+// instructions, branch misses) read through perf_event_open. That needs
+// perf access, i.e. kernel.perf_event_paranoid <= 2 or CAP_PERFMON.
+// Without it the counters are reported as unavailable and the timings
+// still run.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/micro_bench.cpp -o build/micro_bench
+//   ./build/micro_bench [--perf] [--batches N] [--filter TEXT]
+
+#include "attacks.h"
+#include "bench.h"
+#include "board.h"
+#include "evaluate.h"
+#include "game_state.h"
+#include "material.h"
+#include "move_generator.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr int PLAYOUTS_PER_POSITION = 20;
+static constexpr double MIN_BATCH_SECONDS = 0.02;
+
+static volatile uint64_t sink; // Keeps benchmarked results alive
+
+// ============================================================================
+// Hardware Counters
+// ============================================================================
+// One counter group, so all three cover exactly the same instructions.
+
+class PerfCounters {
+  public:
+    static constexpr int COUNT = 3;
+    static constexpr const char *NAMES[COUNT] = { "cycles", "instr", "br-miss" };
+
+    ~PerfCounters() {
+        for ( int fd : fds ) {
+            if ( fd >= 0 )
+                close( fd );
+        }
+    }
+
+    // False when the kernel refuses (no permission, no PMU in a VM, ...)
+    bool Open() {
+        static constexpr uint64_t EVENTS[COUNT] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                    PERF_COUNT_HW_BRANCH_MISSES };
+        for ( int i = 0; i < COUNT; i++ ) {
+            perf_event_attr attr;
+            memset( &attr, 0, sizeof( attr ) );
+            attr.size = sizeof( attr );
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = EVENTS[i];
+            attr.disabled = i == 0; // The group leader starts and stops all of them
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds[i] = static_cast<int>( syscall( __NR_perf_event_open, &attr, 0, -1, i ? fds[0] : -1, 0 ) );
+            if ( fds[i] < 0 )
+                return false;
+        }
+        return true;
+    }
+
+    void Start() {
+        ioctl( fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+        ioctl( fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+    }
+
+    void Stop( uint64_t ( &values )[COUNT] ) {
+        ioctl( fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP );
+        struct {
+            uint64_t count;
+            uint64_t values[COUNT];
+        } group{};
+        if ( read( fds[0], &group, sizeof( group ) ) != sizeof( group ) )
+            memset( &group, 0, sizeof( group ) );
+        std::copy( group.values, group.values + COUNT, values );
+    }
+
+  private:
+    int fds[COUNT] = { -1, -1, -1 };
+};
+
+// ============================================================================
+// Corpus
+// ============================================================================
+
+struct Corpus {
+    std::vector<Board> boards;
+    std::vector<std::vector<Move>> legalMoves; // [board], for make/unmake
+    size_t totalMoves = 0;
+};
+
+static Corpus BuildCorpus() {
+    Corpus corpus;
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    for ( const char *fen : Bench::POSITIONS ) {
+        Board start;
+        start.LoadFEN( fen );
+        corpus.boards.push_back( start );
+
+        Board board = start;
+        for ( int i = 0; i < PLAYOUTS_PER_POSITION; i++ ) {
+            std::vector<Move> moves;
+            GameState::GenerateAllLegalMoves( board, moves, board.whiteToMove );
+            if ( moves.empty() ) {
+                board = start; // Mate or stalemate: start the playout over
+                continue;
+            }
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            board.MakeMove( moves[seed % moves.size()] );
+            corpus.boards.push_back( board );
+        }
+    }
+
+    for ( Board &board : corpus.boards ) {
+        corpus.legalMoves.emplace_back();
+        GameState::GenerateAllLegalMoves( board, corpus.legalMoves.back(), board.whiteToMove );
+        corpus.totalMoves += corpus.legalMoves.back().size();
+    }
+    return corpus;
+}
+
+// ============================================================================
+// Measurement
+// ============================================================================
+
+struct Options {
+    int batches = 10;
+    bool perf = false;
+    std::string filter;
+};
+
+// pass runs the operation over the whole corpus once and returns how many
+// operations that was
+static void Run( const Options &options, PerfCounters *counters, const char *name,
+                 const std::function<size_t()> &pass ) {
+    if ( !options.filter.empty() && std::string( name ).find( options.filter ) == std::string::npos )
+        return;
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    pass(); // Warm-up; also sizes the batches
+    double once = std::chrono::duration<double>( Clock::now() - start ).count();
+    int passesPerBatch = std::max( 1, static_cast<int>( MIN_BATCH_SECONDS / std::max( once, 1e-9 ) ) );
+
+    std::vector<double> nsPerOp;
+    double counterTotals[PerfCounters::COUNT] = {};
+    size_t counterOps = 0;
+    for ( int batch = 0; batch < options.batches; batch++ ) {
+        size_t ops = 0;
+        if ( counters )
+            counters->Start();
+        start = Clock::now();
+        for ( int i = 0; i < passesPerBatch; i++ )
+            ops += pass();
+        double seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+        if ( counters ) {
+            uint64_t values[PerfCounters::COUNT];
+            counters->Stop( values );
+            for ( int i = 0; i < PerfCounters::COUNT; i++ )
+                counterTotals[i] += values[i];
+            counterOps += ops;
+        }
+        nsPerOp.push_back( seconds * 1e9 / ops );
+    }
+
+    std::vector<double> sorted = nsPerOp;
+    std::sort( sorted.begin(), sorted.end() );
+    double mean = 0, variance = 0;
+    for ( double ns : nsPerOp )
+        mean += ns / nsPerOp.size();
+    for ( double ns : nsPerOp )
+        variance += ( ns - mean ) * ( ns - mean ) / nsPerOp.size();
+
+    printf( "%-28s %10.2f %7.1f%% %10.2f", name, sorted[sorted.size() / 2], 100 * std::sqrt( variance ) / mean,
+            sorted[0] );
+    if ( counters ) {
+        for ( double total : counterTotals )
+            printf( " %10.1f", total / counterOps );
+    }
+    printf( "\n" );
+    fflush( stdout );
+}
+
+int main( int argc, char **argv ) {
+    Options options;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        if ( arg == "--perf" )
+            options.perf = true;
+        else if ( arg == "--batches" && i + 1 < argc )
+            options.batches = std::max( 1, atoi( argv[++i] ) );
+        else if ( arg == "--filter" && i + 1 < argc )
+            options.filter = argv[++i];
+    }
+
+    Corpus corpus = BuildCorpus();
+    std::vector<Board> &boards = corpus.boards;
+    printf( "Corpus: %zu positions, %zu legal moves; %d batches per benchmark\n", boards.size(), corpus.totalMoves,
+            options.batches );
+
+    PerfCounters perfCounters;
+    PerfCounters *counters = nullptr;
+    if ( options.perf ) {
+        if ( perfCounters.Open() )
+            counters = &perfCounters;
+        else
+            printf( "Hardware counters unavailable (%s); timing only\n", strerror( errno ) );
+    }
+
+    printf( "\n%-28s %10s %8s %10s", "benchmark", "ns/op", "stddev", "min ns" );
+    if ( counters ) {
+        for ( const char *counter : PerfCounters::NAMES )
+            printf( " %10s", ( std::string( counter ) + "/op" ).c_str() );
+    }
+    printf( "\n" );
+
+    // Attack generation, every square of every position
+    Run( options, counters, "GetBishopAttacks", [&] {
+        uint64_t sum = 0;
+        for ( const Board &board : boards ) {
+            for ( int square = 0; square < 64; square++ )
+                sum += Attacks::GetBishopAttacks( square, board.occupancies[2] );
+        }
+        sink += sum;
+        return boards.size() * 64;
+    } );
+    Run( options, counters, "GetRookAttacks", [&] {
+        uint64_t sum = 0;
+        for ( const Board &board : boards ) {
+            for ( int square = 0; square < 64; square++ )
+                sum += Attacks::GetRookAttacks( square, board.occupancies[2] );
+        }
+        sink += sum;
+        return boards.size() * 64;
+    } );
+    Run( options, counters, "IsSquareAttacked", [&] {
+        uint64_t sum = 0;
+        for ( const Board &board : boards ) {
+            for ( int square = 0; square < 64; square++ ) {
+                sum += MoveGen::IsSquareAttacked( board, square, true );
+                sum += MoveGen::IsSquareAttacked( board, square, false );
+            }
+        }
+        sink += sum;
+        return boards.size() * 128;
+    } );
+
+    // Move generation into a reused list, so allocation isn't timed
+    std::vector<Move> moves;
+    moves.reserve( 256 );
+    Run( options, counters, "GenerateAllPseudoLegal", [&] {
+        for ( const Board &board : boards ) {
+            moves.clear();
+            MoveGen::GenerateAllPseudoLegal( board, moves, board.whiteToMove );
+            sink += moves.size();
+        }
+        return boards.size();
+    } );
+    Run( options, counters, "GenerateAllLegalMoves", [&] {
+        for ( Board &board : boards ) {
+            moves.clear();
+            GameState::GenerateAllLegalMoves( board, moves, board.whiteToMove );
+            sink += moves.size();
+        }
+        return boards.size();
+    } );
+    Run( options, counters, "MakeMove+UndoMove", [&] {
+        for ( size_t i = 0; i < boards.size(); i++ ) {
+            for ( Move &move : corpus.legalMoves[i] ) {
+                boards[i].MakeMove( move );
+                sink += boards[i].hashKey;
+                boards[i].UndoMove( move );
+            }
+        }
+        return corpus.totalMoves;
+    } );
+
+    // Evaluation and its terms, one call per position
+    auto perPosition = [&]( const char *name, const std::function<int( Board & )> &term ) {
+        Run( options, counters, name, [&] {
+            int sum = 0;
+            for ( Board &board : boards )
+                sum += term( board );
+            sink += sum;
+            return boards.size();
+        } );
+    };
+    perPosition( "Evaluate", []( Board &b ) { return Evaluator::Evaluate( b ); } );
+    perPosition( "EvaluateStaticTerms", []( Board &b ) { return Evaluator::EvaluateStaticTerms( b ); } );
+    perPosition( "EvaluateMaterial", []( Board &b ) {
+        return static_cast<int>( Evaluator::EvaluateMaterial( b, MaterialTable::Probe( b ) ) );
+    } );
+    perPosition( "EvaluatePieceSquareTables",
+                 []( Board &b ) { return static_cast<int>( Evaluator::EvaluatePieceSquareTables( b ) ); } );
+    perPosition( "EvaluatePawnStructure (hash)",
+                 []( Board &b ) { return static_cast<int>( Evaluator::EvaluatePawnStructure( b ) ); } );
+    perPosition( "ComputePawnEntry (no hash)", []( Board &b ) {
+        PawnEntry entry;
+        Evaluator::ComputePawnEntry( b.bitboards[WP], b.bitboards[BP], entry );
+        return static_cast<int>( entry.score );
+    } );
+    perPosition( "EvaluatePassedPawns", []( Board &b ) {
+        uint64_t passed;
+        return static_cast<int>( Evaluator::EvaluatePassedPawns( b.bitboards[WP], b.bitboards[BP], true, passed ) -
+                                 Evaluator::EvaluatePassedPawns( b.bitboards[BP], b.bitboards[WP], false, passed ) );
+    } );
+    perPosition( "EvaluateKingSafety", []( Board &b ) {
+        return static_cast<int>( Evaluator::EvaluateKingSafety( b, Evaluator::ProbePawnStructure( b ) ) );
+    } );
+    perPosition( "EvaluatePieceSafety", []( Board &b ) { return Evaluator::EvaluatePieceSafety( b ); } );
+    perPosition( "EvaluateMobility", []( Board &b ) { return static_cast<int>( Evaluator::EvaluateMobility( b ) ); } );
+
+    return 0;
+}
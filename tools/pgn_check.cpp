@@ -0,0 +1,105 @@
+// ============================================================================
+// PGN Check
+// ============================================================================
+// Reads a few small games through pgn.h and checks that each replays to the
+// expected moves and result: castling written with zeros or letters, with
+// check and annotation marks, from a FEN tag, around comments, variations
+// and NAGs. A FEN tag LoadCheckedFen rejects must stop the replay before
+// any move. Exits non-zero on any mismatch.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/pgn_check.cpp -o build/pgn_check
+//   ./build/pgn_check
+
+#include "board.h"
+#include "notation.h"
+#include "pgn.h"
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+struct Expected {
+    const char *event;
+    const char *moves; // UCI, space separated
+    const char *result;
+    const char *badFen = nullptr; // Expected to stop the replay
+};
+
+static constexpr const char *GAMES = R"([Event "Zero castling"]
+
+1. e4 e5 2. Nf3 Nc6 3. Bc4 Bc5 4. 0-0 Nf6 5. d3 0-0 6. Re1 d6 *
+
+[Event "Queenside with check"]
+[FEN "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1"]
+
+1. 0-0-0+ Ke7 2. Rd4 1/2-1/2
+
+[Event "Black first"]
+[FEN "r3k3/8/8/8/8/8/8/4K3 b q - 0 1"]
+
+1...0-0-0 2. Kf2 0-1
+
+[Event "Comments and variations"]
+
+1. e4 {best by test} e5 (1... c5 2. Nf3 (2. c3) d6) 2. Nf3 $1 Nc6 ; to the end of the line
+3. Bb5 a6 1-0
+
+[Event "Annotated"]
+
+1. e4 e5 2. Nf3 Nc6 3. Bc4 Nf6 4. 0-0!? Be7 5. d4 O-O *
+
+[Event "Rookless castling right"]
+[FEN "4k3/8/8/8/8/8/8/4K3 w K - 0 1"]
+
+1. Kd1 Kd7 *
+
+[Event "Nine files"]
+[FEN "4k3/8/8/8/8/8/8/4K3R w - - 0 1"]
+
+1. Kd1 *
+)";
+
+static constexpr Expected EXPECTED[] = {
+    { "Zero castling", "e2e4 e7e5 g1f3 b8c6 f1c4 f8c5 e1g1 g8f6 d2d3 e8g8 f1e1 d7d6", "*" },
+    { "Queenside with check", "e1c1 d8e7 d1d4", "1/2-1/2" },
+    { "Black first", "e8c8 e1f2", "0-1" },
+    { "Comments and variations", "e2e4 e7e5 g1f3 b8c6 f1b5 a7a6", "1-0" },
+    { "Annotated", "e2e4 e7e5 g1f3 b8c6 f1c4 g8f6 e1g1 f8e7 d2d4 e8g8", "*" },
+    { "Rookless castling right", "e1d1 e8d7", "*" },
+    { "Nine files", "", "", "4k3/8/8/8/8/8/8/4K3R w - - 0 1" },
+};
+
+int main() {
+    int failures = 0;
+    size_t index = 0;
+    Pgn::Reader reader( GAMES );
+    Pgn::GameText game;
+    Board board;
+    while ( reader.Next( game ) ) {
+        if ( index >= std::size( EXPECTED ) ) {
+            printf( "FAIL: more games than expected\n" );
+            return 1;
+        }
+        const Expected &expected = EXPECTED[index++];
+        std::string moves;
+        Pgn::Replayed replayed = Pgn::Replay( game, board, [&]( const Board &, const Move &move ) {
+            moves += ( moves.empty() ? "" : " " ) + ToUci( move );
+            return true;
+        } );
+        bool ok = replayed.complete == !expected.badFen && moves == expected.moves &&
+                  replayed.result == expected.result && game.TagValue( "Event" ) == expected.event &&
+                  replayed.badFen == ( expected.badFen ? expected.badFen : "" );
+        printf( "%-24s %s\n", expected.event, ok ? "ok" : "FAILED" );
+        if ( !ok ) {
+            printf( "  read \"%s\" %s, stopped at \"%s\"\n", moves.c_str(), std::string( replayed.result ).c_str(),
+                    std::string( replayed.badMove ).c_str() );
+            failures++;
+        }
+    }
+    if ( index != std::size( EXPECTED ) ) {
+        printf( "FAIL: read %zu of %zu games\n", index, std::size( EXPECTED ) );
+        failures++;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+// ============================================================================
+// PGN Scanner
+// ============================================================================
+// Reads a PGN collection through pgn.h, replays every game and reports the
+// throughput in positions per second. With --threads the file is split at
+// game boundaries and the pieces are read in parallel. --write re-emits the
+// replayed games through the PGN writer, in input order, so a file the
+// writer produced round-trips byte for byte.
+//
+// --generate writes random games (uniform legal moves from the initial
+// position, up to 200 plies) for benchmarking without a game database.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/pgn_scan.cpp -o build/pgn_scan
+//   ./build/pgn_scan GAMES.pgn [--threads N] [--write OUT.pgn]
+//   ./build/pgn_scan --generate GAMES OUT.pgn [--seed N]
+
+#include "board.h"
+#include "game_state.h"
+#include "notation.h"
+#include "pgn.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+static constexpr int GENERATED_MAX_PLIES = 200;
+static constexpr int REPORTED_ERRORS = 5;
+
+struct ScanStats {
+    size_t games = 0;
+    size_t positions = 0;
+    size_t incomplete = 0;
+    double cpuSeconds = 0;
+    std::vector<std::string> errors;
+    std::string output;
+};
+
+static double ThreadCpuSeconds() {
+    timespec now;
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &now );
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// The fullmove number of a FEN, 1 when it has none
+static int FirstMoveNumber( std::string_view fen ) {
+    size_t space = fen.find_last_of( ' ' );
+    int number = space == std::string_view::npos ? 0 : atoi( std::string( fen.substr( space + 1 ) ).c_str() );
+    return std::max( 1, number );
+}
+
+static void ScanGame( const Pgn::GameText &game, bool write, ScanStats &stats, Board &board,
+                      std::vector<Move> &moves ) {
+    Board start;
+    moves.clear();
+    Pgn::Replayed replayed = Pgn::Replay( game, board, [&]( const Board &position, const Move &move ) {
+        if ( write ) {
+            if ( moves.empty() )
+                start = position;
+            moves.push_back( move );
+        }
+        return true;
+    } );
+    stats.games++;
+    stats.positions += replayed.plies;
+    if ( !replayed.complete ) {
+        stats.incomplete++;
+        if ( stats.errors.size() < REPORTED_ERRORS ) {
+            std::string_view event = game.TagValue( "Event" );
+            if ( !replayed.badFen.empty() )
+                stats.errors.push_back( "\"" + std::string( event ) + "\" bad FEN " + std::string( replayed.badFen ) );
+            else
+                stats.errors.push_back( "\"" + std::string( event ) + "\" ply " +
+                                        std::to_string( replayed.plies + 1 ) + ": " + std::string( replayed.badMove ) );
+        }
+    }
+
+    if ( write && replayed.badFen.empty() ) { // A game without a usable start is reported, not rewritten
+        if ( moves.empty() )
+            start = board;
+        std::vector<std::pair<std::string, std::string>> tags;
+        for ( const Pgn::Tag &tag : game.tags )
+            tags.emplace_back( tag.name, tag.value );
+        std::string_view result = replayed.result.empty() ? game.TagValue( "Result" ) : replayed.result;
+        Pgn::AppendGame( stats.output, tags, start, moves, result.empty() ? "*" : result,
+                         FirstMoveNumber( game.TagValue( "FEN" ) ) );
+    }
+}
+
+static int Scan( const std::string &path, int threads, const std::string &writePath ) {
+    Pgn::MappedFile file;
+    if ( !file.Open( path ) ) {
+        fprintf( stderr, "Cannot open %s\n", path.c_str() );
+        return 1;
+    }
+    bool write = !writePath.empty();
+    std::vector<ScanStats> stats( threads );
+    auto start = std::chrono::steady_clock::now();
+    Pgn::ParallelForEach( file.Text(), threads, [&]( int thread, const Pgn::GameText &game ) {
+        thread_local Board board;
+        thread_local std::vector<Move> moves;
+        ScanGame( game, write, stats[thread], board, moves );
+        stats[thread].cpuSeconds = ThreadCpuSeconds();
+    } );
+    double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    ScanStats total;
+    for ( const ScanStats &piece : stats ) {
+        total.games += piece.games;
+        total.positions += piece.positions;
+        total.incomplete += piece.incomplete;
+        total.cpuSeconds += piece.cpuSeconds;
+        total.errors.insert( total.errors.end(), piece.errors.begin(), piece.errors.end() );
+    }
+    printf( "%zu games, %zu positions, %zu stopped early, %.1f MB in %.3f s on %d threads\n", total.games,
+            total.positions, total.incomplete, file.Text().size() / 1e6, seconds, threads );
+    printf( "%.0f positions/s, %.0f positions/s per thread (CPU time)\n", total.positions / seconds,
+            total.cpuSeconds > 0 ? total.positions / total.cpuSeconds : 0.0 );
+    for ( size_t i = 0; i < total.errors.size() && i < REPORTED_ERRORS; i++ )
+        printf( "  stopped at %s\n", total.errors[i].c_str() );
+
+    if ( write ) {
+        std::ofstream out( writePath, std::ios::binary );
+        for ( const ScanStats &piece : stats )
+            out << piece.output;
+        if ( !out ) {
+            fprintf( stderr, "Cannot write %s\n", writePath.c_str() );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int Generate( size_t games, const std::string &path, uint64_t seed ) {
+    std::mt19937_64 random( seed );
+    std::string text;
+    std::vector<Move> legal, moves;
+    size_t positions = 0;
+    for ( size_t game = 0; game < games; game++ ) {
+        Board start;
+        start.Reset();
+        Board board = start;
+        moves.clear();
+        std::string result = "1/2-1/2";
+        for ( int ply = 0; ply < GENERATED_MAX_PLIES; ply++ ) {
+            GameState::GenerateAllLegalMoves( board, legal, board.whiteToMove );
+            if ( legal.empty() ) {
+                if ( GameState::IsKingInCheck( board, board.whiteToMove ) )
+                    result = board.whiteToMove ? "0-1" : "1-0";
+                break;
+            }
+            Move move = legal[random() % legal.size()];
+            moves.push_back( move );
+            board.MakeMove( move );
+        }
+        positions += moves.size();
+        Pgn::AppendGame( text,
+                         { { "Event", "Random game " + std::to_string( game + 1 ) },
+                           { "White", "random" },
+                           { "Black", "random" },
+                           { "Result", result } },
+                         start, moves, result );
+    }
+
+    std::ofstream out( path, std::ios::binary );
+    out << text;
+    if ( !out ) {
+        fprintf( stderr, "Cannot write %s\n", path.c_str() );
+        return 1;
+    }
+    printf( "%zu games, %zu positions written to %s\n", games, positions, path.c_str() );
+    return 0;
+}
+
+int main( int argc, char **argv ) {
+    if ( argc >= 4 && std::string( argv[1] ) == "--generate" ) {
+        uint64_t seed = 1;
+        if ( argc >= 6 && std::string( argv[4] ) == "--seed" )
+            seed = strtoull( argv[5], nullptr, 10 );
+        return Generate( strtoull( argv[2], nullptr, 10 ), argv[3], seed );
+    }
+
+    std::string input, writePath;
+    int threads = 1;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        if ( arg == "--threads" && i + 1 < argc ) {
+            threads = std::max( 1, atoi( argv[++i] ) );
+        } else if ( arg == "--write" && i + 1 < argc ) {
+            writePath = argv[++i];
+        } else if ( arg[0] != '-' && input.empty() ) {
+            input = arg;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+    if ( input.empty() ) {
+        fprintf( stderr,
+                 "Usage: %s GAMES.pgn [--threads N] [--write OUT.pgn]\n"
+                 "       %s --generate GAMES OUT.pgn [--seed N]\n",
+                 argv[0], argv[0] );
+        return 1;
+    }
+    return Scan( input, threads, writePath );
+}
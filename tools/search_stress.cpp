@@ -0,0 +1,198 @@
+// ============================================================================
+// Search Stress Test
+// ============================================================================
+// Many threads searching at once, for the ThreadSanitizer build. Exits
+// non-zero on any mismatch.
+//
+//   1. Every thread searches through one shared SearchEngine with no
+//      transposition table; each fixed-depth result must match the serial
+//      reference exactly (move, score, nodes), since only the per-call
+//      context is written.
+//   2. The threads share one engine and one transposition table under
+//      node and time limits; every search must return a legal move and the
+//      engine's node counter must equal the sum of the results.
+//   3. Engines sharing a table are stopped from another thread mid-search,
+//      and limits on one search must not stop its neighbours.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O1 -g -fsanitize=thread -pthread -Isrc tools/search_stress.cpp -o build/search_stress_tsan
+//   ./build/search_stress_tsan [--threads N] [--rounds N]   (8 and 12 by default; fewer under TSan)
+
+#include "bench.h"
+#include "board.h"
+#include "game_state.h"
+#include "search.h"
+#include "tt.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr int REFERENCE_DEPTH = 3;
+static constexpr size_t POSITION_COUNT = 24; // From the bench set; enough variety, quick under TSan
+
+static std::atomic<int> failures{ 0 };
+
+static void Fail( const std::string &message ) {
+    failures++;
+    fprintf( stderr, "FAIL: %s\n", message.c_str() );
+}
+
+static Board LoadPosition( size_t index ) {
+    Board board;
+    board.LoadFEN( Bench::POSITIONS[index % POSITION_COUNT] );
+    return board;
+}
+
+static bool IsLegal( Board &board, const Move &move ) {
+    std::vector<Move> moves;
+    GameState::GenerateAllLegalMoves( board, moves, board.whiteToMove );
+    return std::any_of( moves.begin(), moves.end(), [&move]( const Move &m ) {
+        return m.fromSquare == move.fromSquare && m.toSquare == move.toSquare && m.promotedPiece == move.promotedPiece;
+    } );
+}
+
+template <typename Body> static void RunThreads( int threads, Body body ) {
+    std::vector<std::thread> pool;
+    for ( int t = 0; t < threads; t++ )
+        pool.emplace_back( body, t );
+    for ( auto &thread : pool )
+        thread.join();
+}
+
+// Phase 1: concurrent fixed-depth searches must reproduce the serial results
+static void SharedEngineDeterminism( int threads, int rounds ) {
+    SearchEngine engine;
+    engine.verbose = false;
+    SearchEngine::SearchLimits limits;
+    limits.depth = REFERENCE_DEPTH;
+
+    std::vector<SearchEngine::SearchResult> reference( POSITION_COUNT );
+    for ( size_t i = 0; i < POSITION_COUNT; i++ ) {
+        Board board = LoadPosition( i );
+        reference[i] = engine.Think( board, limits );
+    }
+
+    RunThreads( threads, [&]( int t ) {
+        for ( int round = 0; round < rounds; round++ ) {
+            size_t index = ( t * 5 + round ) % POSITION_COUNT;
+            Board board = LoadPosition( index );
+            SearchEngine::SearchResult result = engine.Think( board, limits );
+            const SearchEngine::SearchResult &expected = reference[index];
+            if ( result.nodesSearched != expected.nodesSearched || result.score != expected.score ||
+                 result.bestMove.fromSquare != expected.bestMove.fromSquare ||
+                 result.bestMove.toSquare != expected.bestMove.toSquare ) {
+                Fail( "position " + std::to_string( index ) + " differs from the serial search: " +
+                      std::to_string( result.nodesSearched ) + " nodes, expected " +
+                      std::to_string( expected.nodesSearched ) );
+            }
+        }
+    } );
+}
+
+// Phase 2: one engine and one table shared under limits
+static void SharedTable( int threads, int rounds ) {
+    SearchEngine engine;
+    engine.verbose = false;
+    TranspositionTable tt( 4 );
+    engine.tt = &tt;
+    std::atomic<uint64_t> totalNodes{ 0 };
+
+    RunThreads( threads, [&]( int t ) {
+        for ( int round = 0; round < rounds; round++ ) {
+            size_t index = ( t * 3 + round ) % POSITION_COUNT;
+            Board board = LoadPosition( index );
+            SearchEngine::SearchLimits limits;
+            if ( round % 2 )
+                limits.nodes = 2000 + 500 * t;
+            else
+                limits.milliseconds = 20;
+            SearchEngine::SearchResult result = engine.Think( board, limits );
+            totalNodes += result.nodesSearched;
+
+            bool hasMoves = !GameState::IsCheckmate( board, board.whiteToMove ) &&
+                            !GameState::IsStalemate( board, board.whiteToMove );
+            if ( hasMoves && ( result.pv.empty() || !IsLegal( board, result.bestMove ) ) )
+                Fail( "position " + std::to_string( index ) + " returned no legal move" );
+        }
+    } );
+
+    if ( engine.NodesSearched() != totalNodes.load() )
+        Fail( "node counter " + std::to_string( engine.NodesSearched() ) + " != sum of results " +
+              std::to_string( totalNodes.load() ) );
+}
+
+// Phase 3: external stops, and node limits that must stay local
+static void Stops( int threads, int rounds ) {
+    TranspositionTable tt( 4 );
+    std::vector<std::unique_ptr<SearchEngine>> engines;
+    for ( int t = 0; t < threads; t++ ) {
+        engines.push_back( std::make_unique<SearchEngine>() );
+        engines.back()->verbose = false;
+        engines.back()->tt = &tt;
+    }
+
+    for ( int round = 0; round < rounds; round++ ) {
+        std::atomic<int> running{ 0 };
+        RunThreads( threads + 1, [&]( int t ) {
+            if ( t == threads ) { // The stopper
+                while ( running.load() < threads )
+                    std::this_thread::yield();
+                std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+                for ( int e = 0; e < threads; e += 2 )
+                    engines[e]->stop.store( true );
+                return;
+            }
+
+            // Even engines run until stopped; odd ones stop on a small node limit
+            SearchEngine &engine = *engines[t];
+            Board board = LoadPosition( t + round );
+            SearchEngine::SearchLimits limits;
+            if ( t % 2 )
+                limits.nodes = 3000;
+            running++;
+            SearchEngine::SearchResult result = engine.Think( board, limits );
+            if ( t % 2 && result.nodesSearched > limits.nodes + 1 )
+                Fail( "node limit overrun: " + std::to_string( result.nodesSearched ) );
+            if ( t % 2 && engine.stop.load() )
+                Fail( "a node limit set the engine's stop flag" );
+        } );
+        for ( auto &engine : engines )
+            engine->stop.store( false );
+    }
+}
+
+int main( int argc, char **argv ) {
+    int threads = 8, rounds = 12;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        if ( arg == "--threads" && i + 1 < argc ) {
+            threads = std::max( 2, atoi( argv[++i] ) );
+        } else if ( arg == "--rounds" && i + 1 < argc ) {
+            rounds = std::max( 1, atoi( argv[++i] ) );
+        } else {
+            fprintf( stderr, "Usage: %s [--threads N] [--rounds N]\n", argv[0] );
+            return 1;
+        }
+    }
+
+    auto phase = [&]( const char *name, void ( *run )( int, int ) ) {
+        int before = failures.load();
+        auto start = std::chrono::steady_clock::now();
+        run( threads, rounds );
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        printf( "%-28s %s (%.1f s)\n", name, failures.load() == before ? "ok" : "FAILED", seconds );
+        fflush( stdout );
+    };
+    printf( "%d threads, %d rounds\n", threads, rounds );
+    phase( "Shared engine, determinism", SharedEngineDeterminism );
+    phase( "Shared engine and table", SharedTable );
+    phase( "Stops and local limits", Stops );
+    return failures.load() ? 1 : 0;
+}
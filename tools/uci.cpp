@@ -0,0 +1,450 @@
+// ============================================================================
+// UCI Engine
+// ============================================================================
+// Headless engine speaking the Universal Chess Interface, for chess GUIs,
+// match runners and testing tools; it does not link raylib. The main thread
+// only reads commands, so "stop" lands while a search runs and is seen by the
+// search at its next node.
+//
+// Threads > 1 searches lazy SMP style: every worker searches the same
+// position and shares one transposition table; odd helpers start a ply
+// deeper so the workers spread out. Workers are persistent threads, which
+// keeps their thread_local evaluation caches warm from move to move.
+//
+// The Book option names an opening book built by tools/make_book.cpp; a
+// position in the book is answered at once with the book's best move.
+//
+// The endgame bitbases (bitbase.h) take a couple of seconds to build, so
+// they are built on a thread started after "uciok"; "isready", "go" and
+// "bench" wait for it, as UCI allows slow setup to delay "readyok".
+//
+// Besides the UCI commands, "bench [depth]" runs the fixed benchmark in
+// bench.h, also available straight from the command line.
+//
+// Build and run (tools/build.sh builds every tool):
+//   g++ -std=c++17 -O2 -march=native -pthread -Isrc tools/uci.cpp -o build/uci
+//   ./build/uci
+//   ./build/uci bench [depth]
+
+#include "bench.h"
+#include "bitbase.h"
+#include "board.h"
+#include "book.h"
+#include "notation.h"
+#include "search.h"
+#include "tt.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr const char *ENGINE_NAME = "Chess";
+static constexpr int MAX_HASH_MB = 4096;
+static constexpr int MAX_THREADS = 64;
+static constexpr int DEFAULT_MOVES_TO_GO = 30;
+static constexpr int64_t MOVE_OVERHEAD_MS = 20; // Slack for the GUI and the last clock check
+
+using Clock = std::chrono::steady_clock;
+
+// ============================================================================
+// Output
+// ============================================================================
+// Workers and the input thread both write; whole lines only.
+
+static std::mutex outputMutex;
+
+static void Send( const std::string &line ) {
+    std::lock_guard<std::mutex> lock( outputMutex );
+    std::cout << line << '\n' << std::flush;
+}
+
+// ============================================================================
+// Go Parameters
+// ============================================================================
+
+struct GoParams {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int64_t movetime = 0;
+    int64_t time[2] = { 0, 0 }; // [WHITE_SIDE / BLACK_SIDE] remaining ms
+    int64_t inc[2] = { 0, 0 };
+    int movesToGo = 0;
+    bool infinite = false;
+};
+
+static GoParams ParseGo( std::istringstream &in ) {
+    GoParams go;
+    std::string token;
+    while ( in >> token ) {
+        if ( token == "depth" )
+            in >> go.depth;
+        else if ( token == "nodes" )
+            in >> go.nodes;
+        else if ( token == "movetime" )
+            in >> go.movetime;
+        else if ( token == "wtime" )
+            in >> go.time[WHITE_SIDE];
+        else if ( token == "btime" )
+            in >> go.time[BLACK_SIDE];
+        else if ( token == "winc" )
+            in >> go.inc[WHITE_SIDE];
+        else if ( token == "binc" )
+            in >> go.inc[BLACK_SIDE];
+        else if ( token == "movestogo" )
+            in >> go.movesToGo;
+        else if ( token == "infinite" )
+            go.infinite = true;
+    }
+    return go;
+}
+
+// Milliseconds to spend on this move, 0 for no time limit
+static int64_t TimeBudget( const GoParams &go, bool whiteToMove ) {
+    if ( go.infinite )
+        return 0;
+    if ( go.movetime > 0 )
+        return std::max<int64_t>( 1, go.movetime - MOVE_OVERHEAD_MS / 2 );
+
+    int side = whiteToMove ? WHITE_SIDE : BLACK_SIDE;
+    int64_t remaining = go.time[side];
+    if ( remaining <= 0 )
+        return 0;
+    int movesToGo = go.movesToGo > 0 ? go.movesToGo : DEFAULT_MOVES_TO_GO;
+    int64_t budget = remaining / movesToGo + go.inc[side] * 3 / 4;
+    budget = std::min( budget, remaining / 2 ) - MOVE_OVERHEAD_MS;
+    return std::max<int64_t>( 1, budget );
+}
+
+// ============================================================================
+// Engine
+// ============================================================================
+
+class UciEngine {
+  public:
+    UciEngine() {
+        position.Reset();
+        StartWorkers( 1 );
+    }
+
+    ~UciEngine() {
+        StopWorkers();
+        if ( bitbaseBuild.joinable() )
+            bitbaseBuild.join();
+    }
+
+    void Loop() {
+        std::string line;
+        while ( std::getline( std::cin, line ) ) {
+            std::istringstream in( line );
+            std::string command;
+            in >> command;
+
+            if ( command == "uci" ) {
+                Send( std::string( "id name " ) + ENGINE_NAME );
+                Send( "id author efekaanefe" );
+                Send( "option name Hash type spin default " + std::to_string( TranspositionTable::DEFAULT_MB ) +
+                      " min 1 max " + std::to_string( MAX_HASH_MB ) );
+                Send( "option name Threads type spin default 1 min 1 max " + std::to_string( MAX_THREADS ) );
+                Send( "option name Book type string default <empty>" );
+                Send( "uciok" );
+                if ( !bitbaseBuild.joinable() && !bitbasesReady )
+                    bitbaseBuild = std::thread( [] { Bitbases::Init(); } );
+            } else if ( command == "isready" ) {
+                WaitForBitbases();
+                Send( "readyok" );
+            } else if ( command == "setoption" ) {
+                SetOption( in );
+            } else if ( command == "ucinewgame" ) {
+                WaitForSearch( true );
+                tt.Clear();
+            } else if ( command == "position" ) {
+                SetPosition( in );
+            } else if ( command == "go" ) {
+                WaitForBitbases(); // Before the clock starts
+                Go( ParseGo( in ) );
+            } else if ( command == "stop" ) {
+                RequestStop();
+            } else if ( command == "bench" ) {
+                WaitForSearch( true );
+                WaitForBitbases();
+                int depth = Bench::DEFAULT_DEPTH;
+                in >> depth;
+                Bench::Run( depth );
+            } else if ( command == "quit" ) {
+                break;
+            }
+        }
+        WaitForSearch( true );
+    }
+
+  private:
+    struct Worker {
+        int id = 0;
+        SearchEngine engine;
+        SearchEngine::SearchResult result;
+        std::thread thread;
+    };
+
+    Board position;
+    TranspositionTable tt;
+    std::thread bitbaseBuild; // Started after "uciok"
+    bool bitbasesReady = false;
+    OpeningBook book; // Open when the Book option names a file
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Job hand-off: workers wake when generation changes and copy the job
+    std::mutex poolMutex;
+    std::condition_variable poolChanged;
+    uint64_t generation = 0;
+    int running = 0;
+    bool quitting = false;
+    bool stopRequested = false; // A "stop" arrived; ends an infinite search
+    Board jobBoard;
+    GoParams jobGo;
+    int64_t jobBudget = 0;
+    Clock::time_point jobStart;
+
+    // Joins the background build, or builds the tables here if it never started
+    void WaitForBitbases() {
+        if ( bitbaseBuild.joinable() )
+            bitbaseBuild.join();
+        Bitbases::Init();
+        bitbasesReady = true;
+    }
+
+    // ========================================================================
+    // Commands
+    // ========================================================================
+
+    void SetOption( std::istringstream &in ) {
+        std::string token, name, value;
+        in >> token; // "name"
+        while ( in >> token && token != "value" )
+            name += ( name.empty() ? "" : " " ) + token;
+        std::getline( in >> std::ws, value ); // Book paths may contain spaces
+
+        WaitForSearch( true );
+        if ( name == "Hash" ) {
+            tt.Resize( std::clamp( atoi( value.c_str() ), 1, MAX_HASH_MB ) );
+        } else if ( name == "Threads" ) {
+            StopWorkers();
+            StartWorkers( std::clamp( atoi( value.c_str() ), 1, MAX_THREADS ) );
+        } else if ( name == "Book" ) {
+            book.Close();
+            if ( !value.empty() && value != "<empty>" && !book.Open( value ) )
+                Send( "info string cannot open book " + value );
+            for ( auto &worker : workers )
+                worker->engine.book = book.IsOpen() ? &book : nullptr;
+        } else {
+            Send( "info string unknown option " + name );
+        }
+    }
+
+    void SetPosition( std::istringstream &in ) {
+        std::string token;
+        in >> token;
+        Board board;
+        if ( token == "startpos" ) {
+            board.Reset();
+            in >> token; // "moves", if any
+        } else if ( token == "fen" ) {
+            std::string fen;
+            while ( in >> token && token != "moves" )
+                fen += ( fen.empty() ? "" : " " ) + token;
+            if ( !LoadCheckedFen( board, fen ) ) {
+                Send( "info string bad fen " + fen ); // The previous position stays
+                return;
+            }
+        } else {
+            return;
+        }
+
+        while ( in >> token ) {
+            Move move( 0, 0 );
+            if ( !ParseUci( board, token, move ) ) {
+                Send( "info string illegal move " + token );
+                break;
+            }
+            board.MakeMove( move );
+        }
+        position = board;
+    }
+
+    void Go( const GoParams &go ) {
+        WaitForSearch( true );
+        for ( auto &worker : workers ) {
+            worker->engine.stop.store( false );
+            worker->engine.ResetNodesSearched(); // Info lines may be sent before every helper starts
+        }
+
+        std::lock_guard<std::mutex> lock( poolMutex );
+        jobBoard = position;
+        jobGo = go;
+        jobBudget = TimeBudget( go, position.whiteToMove );
+        jobStart = Clock::now();
+        stopRequested = false;
+        running = static_cast<int>( workers.size() );
+        generation++;
+        poolChanged.notify_all();
+    }
+
+    void RequestStop() {
+        {
+            std::lock_guard<std::mutex> lock( poolMutex );
+            stopRequested = true;
+        }
+        for ( auto &worker : workers )
+            worker->engine.stop.store( true );
+        poolChanged.notify_all();
+    }
+
+    // Blocks until no worker is searching; with stopFirst, ends the search
+    // instead of letting it reach its own limits
+    void WaitForSearch( bool stopFirst ) {
+        if ( stopFirst )
+            RequestStop();
+        std::unique_lock<std::mutex> lock( poolMutex );
+        poolChanged.wait( lock, [this] { return running == 0; } );
+    }
+
+    // ========================================================================
+    // Workers
+    // ========================================================================
+
+    void StartWorkers( int count ) {
+        quitting = false;
+        for ( int i = 0; i < count; i++ ) {
+            workers.emplace_back( new Worker );
+            Worker &worker = *workers.back();
+            worker.id = i;
+            worker.engine.verbose = false;
+            worker.engine.tt = &tt;
+            worker.engine.book = book.IsOpen() ? &book : nullptr;
+            worker.thread = std::thread( [this, &worker, seen = generation] { WorkerLoop( worker, seen ); } );
+        }
+    }
+
+    void StopWorkers() {
+        WaitForSearch( true );
+        {
+            std::lock_guard<std::mutex> lock( poolMutex );
+            quitting = true;
+        }
+        poolChanged.notify_all();
+        for ( auto &worker : workers )
+            worker->thread.join();
+        workers.clear();
+    }
+
+    // seen is the generation at creation, so a job posted before the thread runs isn't missed
+    void WorkerLoop( Worker &worker, uint64_t seen ) {
+        for ( ;; ) {
+            std::unique_lock<std::mutex> lock( poolMutex );
+            poolChanged.wait( lock, [&] { return quitting || generation != seen; } );
+            if ( quitting )
+                return;
+            seen = generation;
+            Board board = jobBoard;
+            GoParams go = jobGo;
+            int64_t budget = jobBudget;
+            lock.unlock();
+
+            SearchEngine::SearchLimits limits;
+            if ( go.depth > 0 )
+                limits.depth = go.depth;
+            if ( worker.id == 0 ) {
+                limits.nodes = go.nodes;
+                limits.milliseconds = budget;
+            } else {
+                limits.startDepth = 1 + worker.id % 2;
+            }
+
+            if ( worker.id == 0 ) {
+                worker.result = worker.engine.Think( board, limits, [&]( const SearchEngine::SearchResult &result ) {
+                    SendInfo( result, board );
+                } );
+                FinishSearch( board );
+            } else {
+                worker.result = worker.engine.Think( board, limits );
+            }
+
+            lock.lock();
+            running--;
+            poolChanged.notify_all(); // FinishSearch waits for the helpers, everyone else for zero
+        }
+    }
+
+    // Main worker only: hold the answer of an infinite search until "stop",
+    // halt the helpers, then report the deepest completed result
+    void FinishSearch( const Board &board ) {
+        if ( jobGo.infinite ) {
+            std::unique_lock<std::mutex> lock( poolMutex );
+            poolChanged.wait( lock, [this] { return stopRequested || quitting; } );
+        }
+        for ( auto &worker : workers )
+            worker->engine.stop.store( true );
+        {
+            std::unique_lock<std::mutex> lock( poolMutex );
+            poolChanged.wait( lock, [this] { return running == 1; } );
+        }
+
+        const SearchEngine::SearchResult *best = &workers[0]->result;
+        for ( auto &worker : workers ) {
+            if ( !worker->result.pv.empty() && ( best->pv.empty() || worker->result.depth > best->depth ) )
+                best = &worker->result;
+        }
+        if ( best != &workers[0]->result )
+            SendInfo( *best, board );
+        if ( !best->pv.empty() ) {
+            Send( "bestmove " + ToUci( best->bestMove ) );
+            return;
+        }
+
+        // Stopped before any root move was searched: any legal move beats
+        // 0000, which GUIs take as an illegal move
+        Board root = board;
+        std::vector<Move> legal;
+        GameState::GenerateAllLegalMoves( root, legal, root.whiteToMove );
+        Send( "bestmove " + ( legal.empty() ? std::string( "0000" ) : ToUci( legal[0] ) ) );
+    }
+
+    void SendInfo( const SearchEngine::SearchResult &result, const Board &board ) {
+        uint64_t nodes = 0;
+        for ( auto &worker : workers )
+            nodes += worker->engine.NodesSearched();
+        int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>( Clock::now() - jobStart ).count();
+
+        // Scores are from White's side; UCI wants the side to move's
+        int score = board.whiteToMove ? result.score : -result.score;
+        std::string scoreText = UciScore( board, score, result.pv );
+
+        uint64_t nps = nodes * 1000 / std::max<int64_t>( ms, 1 );
+        std::string line = "info depth " + std::to_string( result.depth ) + " score " + scoreText + " nodes " +
+                           std::to_string( nodes ) + " nps " + std::to_string( nps ) + " time " + std::to_string( ms ) +
+                           " hashfull " + std::to_string( tt.HashFull() ) + " pv";
+        for ( const Move &move : result.pv )
+            line += " " + ToUci( move );
+        Send( line );
+    }
+};
+
+int main( int argc, char **argv ) {
+    if ( argc > 1 && std::string( argv[1] ) == "bench" ) {
+        Bitbases::Init(); // Up front, so no timed search builds them on its first probe
+        Bench::Run( argc > 2 ? atoi( argv[2] ) : Bench::DEFAULT_DEPTH );
+        return 0;
+    }
+
+    std::ios::sync_with_stdio( false );
+    std::cin.tie( nullptr ); // Reading would flush cout from this thread, racing the workers' output
+    UciEngine engine;
+    engine.Loop();
+    return 0;
+}